@@ -0,0 +1,404 @@
+/*!
+ * \file bench.cpp
+ * \brief Benchmarks of the engines of libglife (make bench).
+ *
+ * Every workload is stepped by every engine and thread count, each run in a
+ * child process of its own so that its peak RSS is its own. The results are
+ * written as JSON.
+ *
+ * After its measure, each run steps a few more generations while counting
+ * the heap allocations: once warm, the grid engine must not make any, or
+ * the benchmarks fail.
+ */
+
+// C
+#include <getopt.h>        // getopt_long()
+#include <sys/resource.h>  // getrusage()
+#include <sys/wait.h>      // waitpid()
+#include <unistd.h>        // fork(), pipe()
+
+#include <cstdlib>  // atoi(), std::malloc(), std::free()
+#include <ctime>    // std::time
+
+// C++
+#include <algorithm>  // std::max
+#include <atomic>     // std::atomic
+#include <chrono>     // std::chrono::steady_clock
+#include <fstream>   // std::ofstream
+#include <iostream>  // std::cout, std::cerr
+#include <new>       // std::bad_alloc
+#include <random>    // std::mt19937_64
+#include <sstream>   // std::ostringstream
+#include <string>    // std::string
+#include <thread>    // std::thread::hardware_concurrency
+#include <vector>    // std::vector
+
+#include "../include/board.h"
+#include "../include/engine.h"
+#include "../test/count_allocations.h"
+
+namespace {
+
+//! Generations stepped, once warm, while counting the allocations.
+const long long warm_gens = 64;
+
+//! Board stepped by the benchmarks.
+struct Workload {
+    std::string name;  //!< Name in the results.
+    int rows, cols;    //!< Size of the board.
+    long long gens;    //!< Generations stepped.
+
+    // A random soup, a file, or a pattern centred on the board.
+    double density = 0;             //!< Soup: probability of a living cell.
+    std::string path;               //!< File: .dat, RLE or Life 1.06.
+    std::vector<std::string> cells;  //!< Pattern: rows of '.' and 'O'.
+
+    //! Build the board.
+    bool build(Board &board) const;
+};
+
+//! What a child process measured.
+struct Measure {
+    int ok;                 //!< 0 if the run failed.
+    double seconds;         //!< Time stepping the generations.
+    long long population;   //!< Population after the generations.
+    long long peak_rss_kb;  //!< Peak resident set of the process.
+    long long warm_allocs;  //!< Allocations over warm_gens more generations.
+};
+
+//! One run of the benchmarks.
+struct Result {
+    const Workload *workload;
+    std::string engine;
+    int threads;
+    Measure measure;
+};
+
+bool Workload::build(Board &board) const {
+    if (path != "") {
+        return board.load(path);
+    }
+
+    board = Board(rows, cols);
+
+    if (density > 0) {
+        // Fixed seed: every run steps the same soup.
+        std::mt19937_64 random(rows * 65537ULL + cols);
+        std::bernoulli_distribution alive(density);
+        for (int i = 1; i <= rows; i++) {
+            for (int j = 1; j <= cols; j++) {
+                if (alive(random)) {
+                    board.set(i, j, 1);
+                }
+            }
+        }
+        return true;
+    }
+
+    const int top = (rows - (int)cells.size()) / 2;
+    const int left = (cols - (int)cells[0].size()) / 2;
+    for (std::size_t i = 0; i < cells.size(); i++) {
+        for (std::size_t j = 0; j < cells[i].size(); j++) {
+            if (cells[i][j] == 'O') {
+                board.set(top + (int)i + 1, left + (int)j + 1, 1);
+            }
+        }
+    }
+    return true;
+}
+
+//! The standard workloads.
+std::vector<Workload> workloads() {
+    std::vector<Workload> list;
+
+    // Random soups: sizes that fit in L1, L2 and past the caches.
+    const int sizes[] = {256, 1024, 2048};
+    const long long soup_gens[] = {1000, 200, 50};
+    const double densities[] = {0.1, 0.3, 0.5};
+    for (int s = 0; s < 3; s++) {
+        for (double density : densities) {
+            Workload soup;
+            std::ostringstream name;
+            name << "soup-" << sizes[s] << "-" << density;
+            soup.name = name.str();
+            soup.rows = soup.cols = sizes[s];
+            soup.gens = soup_gens[s];
+            soup.density = density;
+            list.push_back(soup);
+        }
+    }
+
+    Workload selan;
+    selan.name = "selan";
+    selan.path = "data/examples/selan.dat";
+    selan.rows = selan.cols = 0;  // Read from the file.
+    selan.gens = 1000;
+    list.push_back(selan);
+
+    // Methuselahs, up to their stabilisation, on a board that holds most
+    // of their debris.
+    Workload r_pentomino;
+    r_pentomino.name = "r-pentomino";
+    r_pentomino.rows = r_pentomino.cols = 512;
+    r_pentomino.gens = 1103;
+    r_pentomino.cells = {".OO", "OO.", ".O."};
+    list.push_back(r_pentomino);
+
+    Workload acorn;
+    acorn.name = "acorn";
+    acorn.rows = acorn.cols = 512;
+    acorn.gens = 5206;
+    acorn.cells = {".O.....", "...O...", "OO..OOO"};
+    list.push_back(acorn);
+
+    Workload diehard;
+    diehard.name = "diehard";
+    diehard.rows = diehard.cols = 256;
+    diehard.gens = 130;
+    diehard.cells = {"......O.", "OO......", ".O...OOO"};
+    list.push_back(diehard);
+
+    return list;
+}
+
+//! Step a workload in the calling process.
+Measure run(const Workload &workload, const std::string &engine,
+            int threads) {
+    Measure measure = Measure();
+    Board board;
+    EngineConfig config;
+    config.engine = engine;
+    config.threads = threads;
+    config.jump = 62;  // HashLife: the largest steps that fit.
+
+    Engine stepper;
+    if (!workload.build(board) || !stepper.load(board, config)) {
+        return measure;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    stepper.step(workload.gens);
+    const auto stop = std::chrono::steady_clock::now();
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    measure.ok = 1;
+    measure.seconds =
+        std::max(std::chrono::duration<double>(stop - start).count(), 1e-9);
+    measure.population = stepper.population();
+    measure.peak_rss_kb = usage.ru_maxrss;  // KiB on Linux.
+
+    // The measured generations warmed the engine up: its buffers are sized.
+    const long long before = allocations.load();
+    stepper.step(warm_gens);
+    measure.warm_allocs = allocations.load() - before;
+    return measure;
+}
+
+//! Step a workload in a child process.
+Measure run_child(const Workload &workload, const std::string &engine,
+                  int threads) {
+    Measure measure = Measure();
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return measure;
+    }
+
+    const pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        measure = run(workload, engine, threads);
+        const bool sent = write(fds[1], &measure, sizeof measure) ==
+                          (ssize_t)sizeof measure;
+        _exit(sent ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    close(fds[1]);
+    if ((pid < 0) ||
+        (read(fds[0], &measure, sizeof measure) != (ssize_t)sizeof measure)) {
+        measure = Measure();
+    }
+    close(fds[0]);
+
+    if (pid > 0) {
+        waitpid(pid, nullptr, 0);
+    }
+    return measure;
+}
+
+//! Write the results as JSON.
+void write_json(std::ostream &out, const std::vector<Result> &results) {
+    out << "{\n";
+    out << "  \"timestamp\": " << (long long)std::time(nullptr) << ",\n";
+    out << "  \"kernel\": \"" << auto_kernel_name() << "\",\n";
+    out << "  \"hardware_threads\": " << std::thread::hardware_concurrency()
+        << ",\n";
+    out << "  \"results\": [";
+
+    for (std::size_t r = 0; r < results.size(); r++) {
+        const Result &result = results[r];
+        const Workload &workload = *result.workload;
+        const Measure &measure = result.measure;
+        const double cells =
+            (double)workload.rows * workload.cols * workload.gens;
+        const double rate = cells / measure.seconds;
+
+        // Speedup over one thread, per thread.
+        double efficiency = 1;
+        for (const Result &base : results) {
+            if ((base.workload == result.workload) &&
+                (base.engine == result.engine) && (base.threads == 1)) {
+                efficiency = base.measure.seconds /
+                             (measure.seconds * result.threads);
+            }
+        }
+
+        out << (r ? "," : "") << "\n    {";
+        out << "\"workload\": \"" << workload.name << "\", ";
+        out << "\"engine\": \"" << result.engine << "\", ";
+        out << "\"threads\": " << result.threads << ", ";
+        out << "\"rows\": " << workload.rows << ", ";
+        out << "\"cols\": " << workload.cols << ", ";
+        out << "\"generations\": " << workload.gens << ", ";
+        out << "\"seconds\": " << measure.seconds << ", ";
+        out << "\"cell_updates_per_sec\": " << rate << ", ";
+        out << "\"ns_per_cell\": " << 1e9 / rate << ", ";
+        out << "\"peak_rss_kb\": " << measure.peak_rss_kb << ", ";
+        out << "\"warm_allocations\": " << measure.warm_allocs << ", ";
+        out << "\"scaling_efficiency\": " << efficiency << ", ";
+        out << "\"population\": " << measure.population << "}";
+    }
+
+    out << "\n  ]\n}\n";
+}
+
+//! Show the arguments available from cli.
+void print_help() {
+    std::cerr << "Usage: glife_bench [options]\n"
+              << "  -o  --outfile <filename>  Write the JSON there, not to "
+                 "stdout.\n"
+              << "  -t  --threads <num>       Up to this many threads "
+                 "(default: 4).\n"
+              << "  -w  --workload <name>     Only this workload "
+                 "(repeatable).\n"
+              << "  -h  --help                Print this help text.\n";
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    const struct option long_opts[] = {
+        {"help", no_argument, 0, 'h'},
+        {"outfile", 1, 0, 'o'},
+        {"threads", 1, 0, 't'},
+        {"workload", 1, 0, 'w'},
+        {0, 0, 0, 0},
+    };
+
+    std::string outfile;
+    int max_threads = 4;
+    std::vector<std::string> only;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "ho:t:w:", long_opts, NULL)) !=
+           -1) {
+        switch (opt) {
+            case 'o': /* -o or --outfile */
+                outfile = optarg;
+                break;
+            case 't': /* -t or --threads */
+                max_threads = atoi(optarg);
+                break;
+            case 'w': /* -w or --workload */
+                only.push_back(optarg);
+                break;
+            default:
+                print_help();
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (max_threads < 1) {
+        std::cerr << "\n\033[0;31m>>> Error: the number of threads must be "
+                     "positive.\033[0m\n";
+        return EXIT_FAILURE;
+    }
+
+    // Sizes of the files are only known once read.
+    std::vector<Workload> list = workloads();
+    for (Workload &workload : list) {
+        Board board;
+        if ((workload.path != "") && workload.build(board)) {
+            workload.rows = board.rows();
+            workload.cols = board.cols();
+        }
+    }
+
+    std::vector<Result> results;
+    const char *engines[] = {"grid", "sparse", "hashlife"};
+
+    for (const Workload &workload : list) {
+        bool selected = only.empty();
+        for (const std::string &name : only) {
+            selected = selected || (name == workload.name);
+        }
+        if (!selected) {
+            continue;
+        }
+
+        for (const char *engine : engines) {
+            // HashLife runs on a single thread.
+            const int threads_max =
+                (std::string(engine) == "hashlife") ? 1 : max_threads;
+
+            for (int threads = 1; threads <= threads_max; threads *= 2) {
+                Result result;
+                result.workload = &workload;
+                result.engine = engine;
+                result.threads = threads;
+                result.measure = run_child(workload, engine, threads);
+
+                if (!result.measure.ok) {
+                    std::cerr << ">>> " << workload.name << ", " << engine
+                              << ": skipped (cannot load the board).\n";
+                    break;
+                }
+
+                std::cerr << ">>> " << workload.name << ", " << engine
+                          << ", " << threads << " thread(s): "
+                          << workload.gens / result.measure.seconds
+                          << " gens/s\n";
+                results.push_back(result);
+            }
+        }
+    }
+
+    // HashLife makes nodes and the sparse engine tiles as the pattern
+    // grows; the grid engine works in the buffers of load().
+    bool allocated = false;
+    for (const Result &result : results) {
+        if ((result.engine == "grid") && (result.measure.warm_allocs > 0)) {
+            std::cerr << "\n\033[0;31m>>> Error: " << result.workload->name
+                      << ", grid, " << result.threads << " thread(s): "
+                      << result.measure.warm_allocs << " allocations in "
+                      << warm_gens << " warm generations.\033[0m\n";
+            allocated = true;
+        }
+    }
+
+    if (outfile == "") {
+        write_json(std::cout, results);
+        return allocated ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    std::ofstream out(outfile);
+    write_json(out, results);
+    if (!out) {
+        std::cerr << "\n\033[0;31m>>> Error: could not write [" << outfile
+                  << "].\033[0m\n";
+        return EXIT_FAILURE;
+    }
+
+    return allocated ? EXIT_FAILURE : EXIT_SUCCESS;
+}
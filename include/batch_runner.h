@@ -0,0 +1,94 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+// C
+#include <cstddef>  // std::size_t
+#include <cstdint>  // std::uint64_t
+
+// C++
+#include <memory>  // std::unique_ptr
+#include <vector>  // std::vector
+
+#include "board.h"
+#include "engine.h"
+#include "grid.h"
+#include "kernel.h"
+#include "thread_pool.h"
+
+/*!@brief Steps many independent boards at once, with no I/O side effects.
+ *
+ * The boards are packed into one grid, in shelves of rows, with a dead
+ * gutter column between two boards and a dead gutter row between two
+ * shelves; each board then sees dead cells beyond its edges, as on its own.
+ * The kernel steps every shelf in one span, its column mask keeping the
+ * gutters dead; the gutter rows are never stepped, so they stay dead too.
+ * Small boards thus share the vectors and the thread pool instead of paying
+ * for a process, or an Engine, each.
+ */
+class BatchRunner {
+   public:
+    BatchRunner() = default;
+
+    BatchRunner(const BatchRunner &) = delete;
+    BatchRunner &operator=(const BatchRunner &) = delete;
+
+    /*!@brief Pack the boards.
+     *@param Boards, their index in this vector is their index in the batch.
+     *@param Kernel, threads and rule; the engine must be the grid one and
+     *the boundary dead.
+     *@return false if the configuration is invalid.
+     */
+    bool load(const std::vector<Board> &boards, const EngineConfig &config);
+
+    //! Advance every board the given number of generations.
+    void step(long long generations = 1);
+
+    //! Generations advanced since load().
+    long long generation() const { return gen; }
+
+    //! Number of boards.
+    int size() const { return (int)slots.size(); }
+
+    //! Copy of the current generation of a board.
+    Board board(int index) const;
+
+    //! Living cells of a board.
+    long long population(int index) const;
+
+    //! The packed grid.
+    const Grid &cells() const { return front; }
+
+   private:
+    //! Place of a board in the packed grid.
+    struct Slot {
+        int row, col;    //!< Cell (1, 1) of the board in the grid.
+        int rows, cols;  //!< Size of the board.
+        int shelf;       //!< Shelf of the board.
+    };
+
+    //! Rows of the packed grid holding boards side by side.
+    struct Shelf {
+        int row_begin, row_end;  //!< Rows of the shelf.
+        std::size_t words;       //!< Words of the rows holding boards.
+        std::vector<std::uint64_t> mask;  //!< Columns of the boards.
+        std::vector<int> short_slots;  //!< Boards lower than the shelf.
+    };
+
+    //! Step the shelves of a worker.
+    void step_shelves(int worker);
+
+    //! Kill the cells [col_begin, col_end) of a row of the back grid.
+    void clear_cells(int i, int col_begin, int col_end);
+
+    int workers() const { return pool ? pool->size() : 1; }
+
+    std::vector<Slot> slots;            //!< Boards.
+    std::vector<Shelf> shelves;         //!< Shelves of boards.
+    Grid front, back;                   //!< Current and next generation.
+    step_kernel kernel = nullptr;       //!< Bit-parallel rules.
+    Rule rule;                          //!< Rule of the cells.
+    std::unique_ptr<ThreadPool> pool;   //!< Workers, null = one thread.
+    long long gen = 0;                  //!< Generations advanced.
+};
+
+#endif
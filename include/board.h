@@ -0,0 +1,55 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+// C++
+#include <string>  // std::string
+
+#include "grid.h"
+
+/*!@brief Board of cells for the library API, with no I/O side effects.
+ *
+ * Cells are addressed from (1, 1) to (rows(), cols()), like the Grid it
+ * wraps.
+ */
+class Board {
+   public:
+    //! Empty board.
+    Board() = default;
+
+    //! Dead board of the given size.
+    Board(int nRows, int nCols);
+
+    /*!@brief Replace the board by a pattern file (.dat, RLE or Life 1.06).
+     *@return false if the file cannot be read, is invalid, or its board is
+     *too large (PatternFile::max_cells) or does not fit in memory.
+     */
+    bool load(const std::string &path);
+
+    //! Rule given by the last file loaded (RLE "rule = "), empty if none.
+    const std::string &rule() const { return rule_name; }
+
+    //! Number of rows.
+    int rows() const { return grid.rows(); }
+
+    //! Number of columns.
+    int cols() const { return grid.cols(); }
+
+    //! State (alive/dead) of the cell (i, j).
+    int get(int i, int j) const { return grid.get(i, j); }
+
+    //! Set the state (alive/dead) of the cell (i, j).
+    void set(int i, int j, int state) { grid.set(i, j, state); }
+
+    //! Number of living cells.
+    long long population() const { return grid.population(); }
+
+    //! Cells of the board.
+    const Grid &cells() const { return grid; }
+    Grid &cells() { return grid; }
+
+   private:
+    Grid grid;              //!< Cells.
+    std::string rule_name;  //!< Rule of the last file loaded.
+};
+
+#endif
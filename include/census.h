@@ -0,0 +1,202 @@
+#ifndef CENSUS_H
+#define CENSUS_H
+
+// C
+#include <cstddef>  // std::size_t
+#include <cstdint>  // std::int64_t, std::uint64_t
+
+// C++
+#include <string>         // std::string
+#include <unordered_map>  // std::unordered_multimap
+#include <vector>         // std::vector
+
+#include "grid.h"
+#include "kernel.h"
+#include "rule.h"
+#include "thread_pool.h"
+
+//! What an object of a census does over time.
+enum class ObjectKind {
+    still_life,  //!< Never changes.
+    oscillator,  //!< Comes back in place after its period.
+    spaceship,   //!< Comes back, moved, after its period.
+    other        //!< Dies, grows, or takes longer than max_period.
+};
+
+//! Name of a kind, as "still life".
+const char *kind_name(ObjectKind kind);
+
+//! Object found by a census, and how many times.
+struct CensusEntry {
+    std::string name;  //!< Usual name, or kind, size and hash.
+    ObjectKind kind = ObjectKind::other;
+    int period = 0;      //!< Generations to come back, 0 for other.
+    int dx = 0, dy = 0;  //!< Move per period on the board (spaceships).
+    int cells = 0;       //!< Living cells of its smallest phase.
+    long long count = 0;  //!< Objects found by the last census.
+};
+
+/*!@brief Counts the objects a board has settled into.
+ *
+ * The living cells are listed row by row and split into objects with a
+ * union-find over that list: two cells closer than 3 (in both directions)
+ * can share a neighbour, so they belong to the same object. Its memory
+ * follows the living cells, not the size of the board. The rows are cut in
+ * bands, one per worker, each joined on its own, then the seams between the
+ * bands are joined.
+ *
+ * Each object is turned to the orientation (of 8: rotations and
+ * reflections) that gives the smallest hash, and looked up in a table kept
+ * from one census to the next, which holds the cells of each phase in that
+ * orientation: a hash only finds the candidates, the cells decide. An
+ * object not in the table is stepped on its own until it comes back, which
+ * tells its kind, period and move; all its phases then go in the table, so
+ * each object is only stepped once per run. The move of a spaceship is
+ * turned back to the orientation it has on the board, and the spaceships
+ * of a kind going different ways are counted apart.
+ *
+ * Objects that interact at a distance (pseudo still lifes) count as one;
+ * the board is taken as bounded by dead cells.
+ */
+class Census {
+   public:
+    static const int max_period = 64;  //!< Longest period looked for.
+
+    /*!@brief Step the new objects with the given kernel.
+     *@param Kernel following the rule (any-rule kernel unless B3/S23).
+     *@param Rule of the cells; B3/S23 names the common objects.
+     */
+    Census(step_kernel kernel, const Rule &rule);
+
+    /*!@brief Count the objects among the visible cells of a grid.
+     *@param Grid to count.
+     *@param Workers sharing the bands of rows, null = this thread.
+     */
+    void take(const Grid &grid, ThreadPool *pool);
+
+    //! Objects of the last census, the most common first.
+    const std::vector<CensusEntry> &objects() const { return found; }
+
+    //! Objects counted by the last census.
+    long long total() const { return objects_total; }
+
+    //! Phases of objects known to the table.
+    std::size_t table_size() const { return phases.size(); }
+
+   private:
+    //! Cell of the board, or of an object from the corner of its bounding
+    //! box.
+    struct Cell {
+        int x, y;  //!< Column and row.
+
+        bool operator==(const Cell &other) const {
+            return (x == other.x) && (y == other.y);
+        }
+    };
+
+    //! Phase of a known object, in the orientation of its smallest hash.
+    struct Phase {
+        std::vector<Cell> cells;  //!< Row by row, then column by column.
+        int object = 0;           //!< Index of the object in `table`.
+        int dx = 0, dy = 0;       //!< Move per period, in this orientation.
+    };
+
+    //! Object of a census: its entry in `table`, its move on the board.
+    struct Sighting {
+        int object, dx, dy;
+    };
+
+    //! List the living cells of the board and where each row starts.
+    void list_living();
+
+    //! Join the living cells of the rows of a band.
+    void join_band(int band, int bands);
+
+    //! Join the living cells of the first rows of a band to the band above.
+    void join_seam(int row);
+
+    //! Join a living cell to those of rows [from, to) less than 3 columns
+    //! away.
+    void join_rows(std::int64_t cell, int from, int to);
+
+    //! First row of a band.
+    int band_top(int band, int bands) const {
+        return 1 + (int)((long long)board->rows() * band / bands);
+    }
+
+    //! Root of the set of a living cell, halving the path.
+    std::int64_t find(std::int64_t cell);
+
+    //! Merge the sets of two living cells, the smaller index being the root.
+    void unite(std::int64_t a, std::int64_t b);
+
+    /*!@brief Orientation of a shape with the smallest hash over the 8.
+     *@param Cells of the shape.
+     *@param Width of its bounding box.
+     *@param Height of its bounding box.
+     *@param Receives the hash in that orientation.
+     *@return The orientation: bit 0 mirrors the columns, bit 1 the rows,
+     *bit 2 transposes.
+     */
+    static int canonical(const std::vector<Cell> &shape, int w, int h,
+                         std::uint64_t &hash);
+
+    //! Cells of a shape turned to an orientation, in the order of Phase.
+    static void orient(const std::vector<Cell> &shape, int w, int h,
+                       int orientation, std::vector<Cell> &cells);
+
+    //! Turn a move on the board to an orientation, or back with `back`.
+    static void orient_move(int orientation, bool back, int &dx, int &dy);
+
+    //! Hash of a shape as it is.
+    static std::uint64_t shape_hash(const std::vector<Cell> &shape, int w,
+                                    int h);
+
+    /*!@brief Find a shape among the phases of the table.
+     *@param Cells of the shape.
+     *@param Width of its bounding box.
+     *@param Height of its bounding box.
+     *@param Receives its canonical hash.
+     *@param Receives its canonical orientation.
+     *@return The phase, null if the table does not know it.
+     */
+    const Phase *lookup(const std::vector<Cell> &shape, int w, int h,
+                        std::uint64_t &key, int &orientation);
+
+    /*!@brief Step a new object on its own, add its phases to the table.
+     *@param Cells of the object.
+     *@param Width of its bounding box.
+     *@param Height of its bounding box.
+     *@param Its canonical hash.
+     *@param Its canonical orientation.
+     *@return Its phase in the table.
+     */
+    const Phase *classify(const std::vector<Cell> &shape, int w, int h,
+                          std::uint64_t key, int orientation);
+
+    //! Put the common objects of B3/S23 in the table, with their names.
+    void name_objects();
+
+    step_kernel kernel;  //!< Steps the new objects.
+    Rule rule;           //!< Rule of the cells.
+
+    std::unordered_multimap<std::uint64_t, Phase> phases;  //!< By canonical
+                                                           //!< hash.
+    std::vector<CensusEntry> table;  //!< Objects known.
+    std::vector<CensusEntry> found;  //!< Objects of the last census.
+    long long objects_total = 0;     //!< Objects of the last census.
+
+    // Union-find over the living cells of the board, reused from one census
+    // to the next; a set is rooted at its first cell.
+    const Grid *board = nullptr;
+    std::vector<Cell> living;           //!< Living cells, row by row.
+    std::vector<std::int64_t> row_at;   //!< First living cell of each row.
+    std::vector<std::int64_t> parent;   //!< Set, then object, of each.
+    std::vector<Cell> members;          //!< Living cells, object by object.
+    std::vector<std::int64_t> first;    //!< First member of each object.
+    std::vector<Cell> shape;            //!< Cells of the current object.
+    std::vector<Cell> oriented;         //!< Them turned to canonical.
+    std::vector<Sighting> sightings;    //!< Objects of the census.
+};
+
+#endif
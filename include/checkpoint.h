@@ -0,0 +1,102 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+// C
+#include <cstdint>  // std::uint64_t
+
+// C++
+#include <condition_variable>  // std::condition_variable
+#include <mutex>               // std::mutex
+#include <string>              // std::string
+#include <thread>              // std::thread
+#include <vector>              // std::vector
+
+#include "fingerprint.h"
+#include "grid.h"
+#include "rule.h"
+
+//! Generation remembered by the cycle detection.
+struct SnapshotEntry {
+    Fingerprint fingerprint;  //!< Fingerprint of the generation.
+    long long gen;            //!< Number of the generation.
+};
+
+/*!@brief State needed to resume a simulation.
+ *
+ * On disk: a header (magic, version, rows, cols, cell character, rule,
+ * boundary, generation, number of entries, far entry and its span), the
+ * entries, then the visible words of each row.
+ */
+struct Snapshot {
+    Grid cells;                         //!< Current generation.
+    char cell_char = '*';               //!< Character of a living cell.
+    Rule rule;                          //!< Rule of the cells.
+    Boundary boundary = Boundary::dead;  //!< Beyond the edges of the board.
+    long long gen = 0;                  //!< Number of the generation.
+    std::vector<SnapshotEntry> seen;    //!< Last generations seen, in no
+                                        //!< particular order.
+    SnapshotEntry far = {Fingerprint(), -1};  //!< Generation compared with
+                                              //!< for long periods, or -1.
+    long long far_span = 0;  //!< Generations before far moves on.
+};
+
+/*!@brief Read a snapshot written by CheckpointWriter.
+ *@return false if the file cannot be read, is not a snapshot, announces
+ *more entries than it holds, a board of more than PatternFile::max_cells,
+ *or if there is no memory for them.
+ */
+bool read_snapshot(const std::string &path, Snapshot &snapshot);
+
+/*!@brief Writes snapshots on a background thread.
+ *
+ * The caller fills the spare snapshot returned by spare() (the grid copy
+ * reuses its storage) and hands it over with submit(). Each snapshot is
+ * written to a temporary file, synced, then renamed over the checkpoint, so
+ * the checkpoint on disk is always complete, even after a crash.
+ */
+class CheckpointWriter {
+   public:
+    //! Start the writer thread, writing to path.
+    explicit CheckpointWriter(const std::string &path);
+
+    //! Write the snapshot still queued and stop the writer thread.
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter &) = delete;
+    CheckpointWriter &operator=(const CheckpointWriter &) = delete;
+
+    /*!@brief Snapshot to fill before submit().
+     *
+     * A snapshot submitted but not yet taken by the writer is taken back
+     * and replaced, so the newest one is written. The one being written
+     * has storage of its own: the caller never waits.
+     */
+    Snapshot *spare();
+
+    //! Hand the spare snapshot over to the writer thread.
+    void submit();
+
+    //! Whether a snapshot could not be written.
+    bool failed();
+
+   private:
+    //! Loop of the writer thread.
+    void work();
+
+    //! Write `writing` to the temporary file, sync and rename it.
+    bool write();
+
+    std::string path;  //!< Checkpoint file.
+    Snapshot writing;  //!< Snapshot being written.
+    Snapshot queued;   //!< Spare snapshot, filled by the simulation.
+
+    std::thread thread;             //!< Writer.
+    std::mutex lock;                //!< Protects the fields below.
+    std::condition_variable ready;  //!< Signals a new snapshot.
+    bool has_queued = false;        //!< Whether `queued` waits for the writer.
+    bool busy = false;              //!< Whether `writing` is being written.
+    bool write_failed = false;      //!< Whether a write failed.
+    bool stop = false;              //!< Ask the writer to leave.
+};
+
+#endif
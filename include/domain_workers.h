@@ -0,0 +1,85 @@
+#ifndef DOMAIN_WORKERS_H
+#define DOMAIN_WORKERS_H
+
+// C
+#include <sys/types.h>  // pid_t
+
+#include <cstddef>  // std::size_t
+
+// C++
+#include <vector>  // std::vector
+
+#include "fingerprint.h"
+#include "grid.h"
+#include "kernel.h"
+#include "rule.h"
+
+/*!@brief Steps a board split into bands of rows, one worker process each.
+ *
+ * The workers are forked from the calling process and hold the only live
+ * copy of their band (domain): each one frees its copy of the rest of the
+ * board. Each generation, neighbouring workers swap their edge rows over a
+ * socketpair, as the halo rows of the other, then step their domain and
+ * send the changes of fingerprint and population back to the coordinator,
+ * which needs no board of its own. The cells only travel to the
+ * coordinator when gather() asks for them. The edges of the board are
+ * dead.
+ */
+class DomainWorkers {
+   public:
+    DomainWorkers() = default;
+
+    //! Stop the workers and wait for them.
+    ~DomainWorkers();
+
+    DomainWorkers(const DomainWorkers &) = delete;
+    DomainWorkers &operator=(const DomainWorkers &) = delete;
+
+    /*!@brief Fork a worker per domain.
+     *
+     * Call it before starting any thread: the workers only keep the thread
+     * that forked them. Free the other boards of the process first, the
+     * workers would keep them alive.
+     *@param Board to split, its cells are the first generation. Left as it
+     *is in this process, to be freed once no longer needed.
+     *@param Number of workers, at most the number of rows.
+     *@param Kernel stepping the domains.
+     *@param Rule of the cells.
+     *@return false if the workers could not be started.
+     */
+    bool start(Grid &board, int workers, step_kernel kernel,
+               const Rule &rule);
+
+    /*!@brief Step every domain one generation.
+     *@param Receives the changes of fingerprint and population.
+     *@return false if a worker stopped.
+     */
+    bool step(GridDelta &delta);
+
+    /*!@brief Copy the current generation of every domain into board.
+     *
+     * An empty board, or one of another size, is allocated first.
+     *@return false if a worker stopped.
+     */
+    bool gather(Grid &board);
+
+    //! Number of workers.
+    int size() const { return (int)domains.size(); }
+
+   private:
+    //! Coordinator end of a worker.
+    struct Domain {
+        pid_t pid;               //!< Worker process.
+        int fd;                  //!< Socket to the worker.
+        int row_begin, row_end;  //!< Rows of the board it holds.
+    };
+
+    //! Send a command to every worker.
+    bool command(char cmd);
+
+    std::vector<Domain> domains;  //!< Workers, top to bottom.
+    int rows = 0, cols = 0;       //!< Size of the board.
+    std::size_t row_words = 0;    //!< Words of a row of the board.
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+// C++
+#include <memory>  // std::unique_ptr
+#include <string>  // std::string
+#include <vector>  // std::vector
+
+#include "board.h"
+#include "fingerprint.h"
+#include "grid.h"
+#include "hashlife.h"
+#include "kernel.h"
+#include "rule.h"
+#include "sparse_board.h"
+#include "thread_pool.h"
+#include "tile_map.h"
+#include "tile_step.h"
+
+//! How an Engine steps its board.
+struct EngineConfig {
+    std::string engine = "grid";  //!< grid, sparse or hashlife.
+    std::string kernel = "auto";  //!< Step kernel of the grid engine.
+    int threads = 1;              //!< Threads stepping the generations.
+    Rule rule;                    //!< Rule of the cells.
+    Boundary boundary = Boundary::dead;  //!< Beyond the edges (grid).
+    int jump = 0;  //!< log2 of the generations per HashLife step.
+};
+
+/*!@brief Steps a board, with no I/O side effects.
+ *
+ * The grid engine is the one of glife: bit-parallel kernels, tiles that
+ * skip the quiet parts of the board, bands of rows spread over a thread
+ * pool, and fingerprints updated from the words that changed. The sparse
+ * and HashLife engines run on an unbounded plane, the board being a window.
+ */
+class Engine {
+   public:
+    Engine() = default;
+
+    Engine(const Engine &) = delete;
+    Engine &operator=(const Engine &) = delete;
+
+    /*!@brief Start from a board.
+     *@return false if the configuration is invalid (unknown engine or
+     *kernel, kernel not supported by this CPU, B0 or a boundary on an
+     *unbounded engine, jump out of 0..62).
+     */
+    bool load(const Board &board, const EngineConfig &config);
+
+    //! Advance the given number of generations.
+    void step(long long generations = 1);
+
+    //! Generations advanced since load().
+    long long generation() const { return gen; }
+
+    //! Living cells (in the whole plane for sparse and HashLife).
+    long long population() const { return alive; }
+
+    /*!@brief Fingerprint of the living cells (of the whole plane for sparse
+     *and HashLife).
+     *
+     * The grid and sparse engines hash the same way, so their fingerprints
+     * agree while every cell is inside the window. HashLife uses another
+     * function (a polynomial hash of its quadtree): its fingerprints are
+     * only comparable with those of HashLife.
+     */
+    Fingerprint fingerprint() const { return hash; }
+
+    //! Visible cells of the current generation.
+    const Grid &cells() const { return front; }
+
+    //! Copy of the visible cells of the current generation.
+    Board board() const;
+
+   private:
+    //! Advance the grid engine one generation.
+    void step_grid();
+
+    //! Step the active tiles of the band of a worker.
+    void step_band(int band);
+
+    //! First row of tiles of a band.
+    int band_begin(int band) const;
+
+    //! Number of workers.
+    int workers() const { return pool ? pool->size() : 1; }
+
+    EngineConfig config;    //!< Configuration given to load().
+    Grid front, back;       //!< Current and next generation.
+    step_kernel kernel = nullptr;        //!< Bit-parallel rules.
+    std::unique_ptr<ThreadPool> pool;    //!< Workers, null = one thread.
+    std::unique_ptr<HashLife> hashlife;  //!< HashLife engine, or null.
+    std::unique_ptr<SparseBoard> sparse;  //!< Sparse engine, or null.
+    TileMap tiles;                       //!< Tiles to step.
+    std::vector<GridDelta> band_deltas;  //!< Changes found by each worker.
+    Fingerprint hash;                    //!< Fingerprint of `front`.
+    long long alive = 0;                 //!< Population.
+    long long gen = 0;                   //!< Generations advanced.
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef FINGERPRINT_H
+#define FINGERPRINT_H
+
+// C
+#include <cstddef>  // std::size_t
+#include <cstdint>  // std::uint64_t
+
+#include "grid.h"
+
+/*!@brief 128-bit hash of the living cells of a generation.
+ *
+ * The fingerprint of a board is the XOR of the hashes of its non-empty
+ * words, each one mixed with the position of the word. Changing a word only
+ * takes XORing out its old hash and XORing in the new one, so the step
+ * updates the fingerprint incrementally.
+ */
+struct Fingerprint {
+    std::uint64_t lo = 0, hi = 0;  //!< Two independent 64-bit halves.
+
+    inline Fingerprint &operator^=(const Fingerprint &other) {
+        lo ^= other.lo;
+        hi ^= other.hi;
+        return *this;
+    }
+
+    inline bool operator==(const Fingerprint &other) const {
+        return (lo == other.lo) && (hi == other.hi);
+    }
+};
+
+//! Finalizer of splitmix64, a cheap 64-bit mixing function.
+inline std::uint64_t mix64(std::uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/*!@brief Hash of the word w of row i, 0 for an empty word.
+ *@param Row of the word.
+ *@param Index of the word in the row.
+ *@param Cells of the word (visible columns only).
+ */
+inline Fingerprint word_fingerprint(std::uint64_t i, std::uint64_t w,
+                                    std::uint64_t word) {
+    Fingerprint fp;
+    if (word != 0) {
+        const std::uint64_t pos = mix64((i << 32) | w);
+        fp.lo = mix64(word ^ pos);
+        fp.hi = mix64((word + 0x9e3779b97f4a7c15ULL) ^ (pos >> 17) ^
+                      0x632be59bd9b4e019ULL);
+    }
+    return fp;
+}
+
+//! Changes made to a board by one step.
+struct GridDelta {
+    Fingerprint fingerprint;     //!< XOR of the old and new fingerprints.
+    long long population = 0;    //!< New minus old number of living cells.
+    char pad[64 - sizeof(Fingerprint) - sizeof(long long)];  //!< One cache
+                                                             //!< line each.
+};
+
+//! Fingerprint of all visible cells of a grid.
+Fingerprint grid_fingerprint(const Grid &grid);
+
+/*!@brief Compare a block of two generations and add its changes to delta.
+ *@param Current generation.
+ *@param Next generation.
+ *@param First row of the block.
+ *@param Row after the last one of the block.
+ *@param First word of the rows of the block.
+ *@param Word after the last one of the rows of the block.
+ *@param Where the fingerprint and population changes are added.
+ *@param Row of the board of row 0 of the grids, when they hold a band of a
+ *bigger board.
+ *@return true if any cell of the block changed.
+ */
+bool add_block_delta(const Grid &front, const Grid &back, int row_begin,
+                     int row_end, std::size_t word_begin, std::size_t word_end,
+                     GridDelta &delta, int row_offset = 0);
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef FINGERPRINT_INDEX_H
+#define FINGERPRINT_INDEX_H
+
+// C
+#include <cstddef>  // std::size_t
+
+// C++
+#include <vector>  // std::vector
+
+#include "fingerprint.h"
+
+/*!@brief Generations seen before, indexed by their fingerprint.
+ *
+ * An open-addressing table (linear probing, power-of-two capacity) of flat
+ * entries: inserting and erasing never allocate, only growing does, when
+ * the table is half full. Erasing shifts the following entries back instead
+ * of leaving tombstones, so a table of fixed size (the last K generations)
+ * never degrades nor grows once reserved.
+ */
+class FingerprintIndex {
+   public:
+    //! Generation seen before.
+    struct Entry {
+        Fingerprint fingerprint;  //!< Key.
+        long long gen = -1;       //!< Number of the generation, -1 = empty.
+        int slot = -1;  //!< Index of its cells in the log, -1 if gone.
+    };
+
+    /*!@brief Make room for entries without growing.
+     *@param Number of entries.
+     */
+    void reserve(std::size_t entries);
+
+    //! Entry of a fingerprint, null if not seen.
+    const Entry *find(const Fingerprint &fingerprint) const;
+
+    /*!@brief Add a generation, replacing the entry of the same fingerprint.
+     *@param Entry to add (gen >= 0).
+     */
+    void insert(const Entry &entry);
+
+    /*!@brief Remove the entry of a fingerprint if it is still the one of
+     *the given generation.
+     *@return Whether an entry was removed.
+     */
+    bool erase(const Fingerprint &fingerprint, long long gen);
+
+    //! Number of entries.
+    std::size_t size() const { return count; }
+
+   private:
+    //! Slot of the fingerprint, or the empty slot where it would go.
+    std::size_t probe(const Fingerprint &fingerprint) const;
+
+    //! Rebuild the table with the given capacity (a power of two).
+    void rehash(std::size_t capacity);
+
+    std::vector<Entry> table;  //!< Entries and empty slots.
+    std::size_t count = 0;     //!< Entries in the table.
+};
+
+#endif
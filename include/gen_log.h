@@ -0,0 +1,185 @@
+#ifndef GEN_LOG_H
+#define GEN_LOG_H
+
+// C
+#include <cstddef>  // std::size_t
+#include <cstdint>  // std::uint64_t, std::uint32_t
+
+// C++
+#include <condition_variable>  // std::condition_variable
+#include <fstream>             // std::ofstream
+#include <mutex>               // std::mutex
+#include <string>              // std::string
+#include <thread>              // std::thread
+#include <vector>              // std::vector
+
+#include "grid.h"
+
+/*!@brief Layout of a generation log.
+ *
+ * The file holds 64-bit words, in the byte order of the host:
+ *
+ *     LogHeader
+ *     frame...              one per logged generation
+ *     LogIndexEntry...      one per keyframe
+ *     LogTrailer
+ *
+ * A frame is a LogFrame followed by `words` words of RLE data. The data of a
+ * keyframe are the visible cells, row after row, Grid::row_words() words per
+ * row; the data of a delta frame are those words XOR the previous frame. The
+ * RLE is a list of runs: a word holding (zeros << 32) | literals, then the
+ * `literals` words. Zero words are not stored.
+ */
+namespace gen_log {
+
+const char magic[8] = {'G', 'L', 'I', 'F', 'E', 'L', 'O', 'G'};
+const std::uint32_t version = 1;
+
+struct LogHeader {
+    char magic[8];            //!< gen_log::magic.
+    std::uint32_t version;    //!< gen_log::version.
+    std::uint32_t rows;       //!< Visible rows.
+    std::uint32_t cols;       //!< Visible columns.
+    std::uint32_t keyframes;  //!< Frames between two keyframes.
+};
+
+struct LogFrame {
+    std::uint64_t gen;    //!< Number of the generation.
+    std::uint32_t key;    //!< 1 for a keyframe, 0 for a delta frame.
+    std::uint32_t words;  //!< Words of RLE data that follow.
+};
+
+struct LogIndexEntry {
+    std::uint64_t gen;     //!< Number of the generation of the keyframe.
+    std::uint64_t offset;  //!< Offset of its LogFrame in the file.
+};
+
+struct LogTrailer {
+    std::uint64_t index;    //!< Offset of the first LogIndexEntry.
+    std::uint64_t entries;  //!< Number of LogIndexEntry.
+    char magic[8];          //!< gen_log::magic.
+};
+
+}  // namespace gen_log
+
+/*!@brief Records generations in a generation log (see gen_log).
+ *
+ * append() encodes a generation on the calling thread into the front buffer;
+ * once it holds enough data, the buffers are swapped and a background thread
+ * writes the back one, so the simulation only waits on the disk if it fills a
+ * buffer before the previous one is written. Once the buffers have grown to
+ * the largest frame, append() only allocates when the index of the
+ * keyframes, reserved for 4096 of them, doubles.
+ */
+class GenLogWriter {
+   public:
+    /*!@brief Create the file and start the writer thread.
+     *@param Path of the file.
+     *@param Frames between two keyframes.
+     */
+    explicit GenLogWriter(const std::string &path, int keyframes = 256);
+
+    //! Finish the file, see close().
+    ~GenLogWriter();
+
+    GenLogWriter(const GenLogWriter &) = delete;
+    GenLogWriter &operator=(const GenLogWriter &) = delete;
+
+    //! Whether the file could be created.
+    bool is_open() const { return open; }
+
+    /*!@brief Record a generation, all of them of the same size.
+     *@return false if the file could not be written.
+     */
+    bool append(const Grid &cells, long long gen);
+
+    /*!@brief Write the index and the trailer, and stop the writer thread.
+     *@return false if the file could not be written.
+     */
+    bool close();
+
+   private:
+    //! Loop of the writer thread.
+    void work();
+
+    //! Hand the front buffer over to the writer thread.
+    void flush();
+
+    //! Append words to the front buffer.
+    void put(const void *data, std::size_t bytes);
+
+    std::ofstream file;  //!< Log being written.
+    bool open = false;   //!< Whether the file is open and not closed.
+    int keyframes;       //!< Frames between two keyframes.
+    long long frames = 0;       //!< Frames appended.
+    std::uint64_t offset = 0;   //!< Bytes appended.
+    std::vector<std::uint64_t> previous;  //!< Cells of the previous frame.
+    std::vector<gen_log::LogIndexEntry> index;  //!< Keyframes appended.
+    std::vector<char> front;  //!< Data appended and not handed over yet.
+
+    std::thread thread;             //!< Writer.
+    std::mutex lock;                //!< Protects the fields below.
+    std::condition_variable ready;  //!< Signals a new or a written buffer.
+    std::vector<char> back;         //!< Data handed over to the writer.
+    bool has_back = false;          //!< Whether `back` waits to be written.
+    bool failed = false;            //!< Whether a write failed.
+    bool stop = false;              //!< Ask the writer to leave.
+};
+
+/*!@brief Reads a generation log mapped in memory.
+ *
+ * seek() starts from the last keyframe at or before the generation, found by
+ * a binary search of the index, and applies the delta frames that follow, so
+ * it costs at most a keyframe interval of frames whatever the length of the
+ * run.
+ */
+class GenLogReader {
+   public:
+    GenLogReader() = default;
+
+    //! Unmap the file.
+    ~GenLogReader();
+
+    GenLogReader(const GenLogReader &) = delete;
+    GenLogReader &operator=(const GenLogReader &) = delete;
+
+    /*!@brief Map a log and check its header, index and trailer.
+     *@return false if the file cannot be read, is not a generation log, or
+     *its board is empty or has more than PatternFile::max_cells.
+     */
+    bool open(const std::string &path);
+
+    //! Number of visible rows of the generations.
+    int rows() const { return (int)header->rows; }
+
+    //! Number of visible columns of the generations.
+    int cols() const { return (int)header->cols; }
+
+    /*!@brief Restore the last logged generation at or before gen.
+     *@param Number of the generation wanted.
+     *@param Grid of rows() by cols() cells receiving the generation.
+     *@return Number of the generation restored, -1 if none is at or before
+     *gen or the file is damaged.
+     */
+    long long seek(long long gen, Grid &cells) const;
+
+   private:
+    /*!@brief Decode the RLE data of a frame into the visible cells.
+     *@param First RLE word.
+     *@param Number of RLE words.
+     *@param Grid receiving the cells, XOR-ed with them unless key.
+     *@param Whether the frame is a keyframe.
+     *@return false if the data are damaged.
+     */
+    bool decode(const std::uint64_t *data, std::size_t words, Grid &cells,
+                bool key) const;
+
+    const char *map = nullptr;  //!< Mapped file.
+    std::size_t size = 0;       //!< Bytes mapped.
+    const gen_log::LogHeader *header = nullptr;  //!< Start of the file.
+    const gen_log::LogIndexEntry *index = nullptr;  //!< Keyframes.
+    std::size_t entries = 0;    //!< Number of keyframes.
+    std::size_t frames_end = 0;  //!< Offset of the end of the frames.
+};
+
+#endif
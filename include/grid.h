@@ -0,0 +1,119 @@
+#ifndef GRID_H
+#define GRID_H
+
+// C
+#include <cstddef>  // std::size_t
+#include <cstdint>  // std::uint64_t
+
+//! What lies beyond the edges of the board.
+enum class Boundary {
+    dead,   //!< Dead cells.
+    torus,  //!< The opposite edge (wrap around).
+    mirror  //!< The edge itself (reflection).
+};
+
+/*!@brief Contiguous bit-packed board, one bit per cell.
+ *
+ * Cells are addressed like the old petri_dish: rows 0 and nRows + 1 and
+ * columns 0 and nCols + 1 are the dead halo around the visible board. Each
+ * row is stored as 64-bit words (column j lives in bit j % 64 of word j / 64)
+ * and the row stride is rounded up to a whole number of 64-byte cache lines,
+ * always leaving at least one zero word of padding at the end of the row.
+ * One extra guard row before the halo and one after it keep the word-shifted
+ * loads of the step kernels inside the allocation.
+ */
+class Grid {
+   public:
+    static const std::size_t line_words = 8;  //!< Words in a cache line.
+
+    //! Default constructor, empty grid.
+    Grid();
+
+    //! Receive the dimensions of the visible board (without the halo).
+    Grid(int nRows, int nCols);
+
+    Grid(const Grid &other);
+    Grid(Grid &&other);
+
+    //! Copy the cells, reusing the storage when the sizes match.
+    Grid &operator=(const Grid &other);
+    Grid &operator=(Grid &&other);
+
+    //! Desconstructor
+    ~Grid();
+
+    //! Reallocate the grid to the given visible size, all cells dead.
+    void resize(int nRows, int nCols);
+
+    //! Kill every cell, halo included.
+    void clear();
+
+    /*!@brief Fill the halo rows and columns for the boundary condition.
+     *
+     * Done between generations, so the step kernels never check bounds.
+     * Boundary::dead leaves the halo as it is (dead).
+     */
+    void fill_halo(Boundary boundary);
+
+    //! Exchange the storage of two grids.
+    void swap(Grid &other);
+
+    /*!@brief Compare the visible cells of two grids.
+     *@return true if both grids have the same size and living cells.
+     */
+    bool same_cells(const Grid &other) const;
+
+    //! Number of living cells inside the visible board.
+    long long population() const;
+
+    //! State (alive/dead) of the cell (i, j), halo coordinates included.
+    inline int get(int i, int j) const {
+        return (int)((data[(std::size_t)i * stride + ((std::size_t)j >> 6)] >>
+                      (j & 63)) &
+                     1u);
+    }
+
+    //! Set the state (alive/dead) of the cell (i, j).
+    inline void set(int i, int j, int state) {
+        std::uint64_t &w =
+            data[(std::size_t)i * stride + ((std::size_t)j >> 6)];
+        const std::uint64_t bit = std::uint64_t(1) << (j & 63);
+        w = state ? (w | bit) : (w & ~bit);
+    }
+
+    //! Pointer to the first word of row i (0 is the top halo).
+    inline std::uint64_t *row(int i) { return data + (std::size_t)i * stride; }
+    inline const std::uint64_t *row(int i) const {
+        return data + (std::size_t)i * stride;
+    }
+
+    //! Words of a row that hold cells, halo columns included.
+    inline std::size_t row_words() const { return used_words; }
+
+    //! Words between the start of two consecutive rows.
+    inline std::size_t row_stride() const { return stride; }
+
+    //! One row of words with the bits of the visible columns set.
+    inline const std::uint64_t *interior_mask() const { return mask; }
+
+    //! Number of visible rows.
+    inline int rows() const { return num_rows; }
+
+    //! Number of visible columns.
+    inline int cols() const { return num_cols; }
+
+    //! Bytes reserved for the cells (guard rows and mask included).
+    std::size_t bytes() const;
+
+   private:
+    void allocate();
+
+    std::uint64_t *buffer = nullptr;  //!< Aligned allocation.
+    std::uint64_t *data = nullptr;    //!< First word of row 0.
+    std::uint64_t *mask = nullptr;    //!< Visible column mask (one row).
+    int num_rows = 0, num_cols = 0;   //!< Visible dimensions.
+    std::size_t used_words = 0;       //!< Words holding columns 0..nCols+1.
+    std::size_t stride = 0;           //!< Words per row.
+};
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef HASHLIFE_H
+#define HASHLIFE_H
+
+// C
+#include <cstddef>  // std::size_t
+#include <cstdint>  // std::uint32_t, std::int64_t
+
+// C++
+#include <unordered_map>  // std::unordered_map
+#include <vector>         // std::vector
+
+#include "fingerprint.h"
+#include "grid.h"
+#include "rule.h"
+
+/*!@brief HashLife engine: a memoized quadtree of canonical nodes.
+ *
+ * The plane is unbounded; the board of the simulation is only the window
+ * that is loaded and rendered. Every distinct square of cells is stored once
+ * (hash-consed) and remembers its centre some generations ahead, so repeated
+ * structure in space and time is computed once and a step of 2^k
+ * generations costs about as much as the pattern has distinct nodes.
+ *
+ * Any Life-like rule without B0 works: empty space must stay empty.
+ *
+ * Every node also keeps a hash of its cells that does not depend on where
+ * it is: the sum of x^i y^j over its living cells (i, j), modulo 2^61 - 1,
+ * with two pairs of bases. It adds up from the quadrants in join(), and
+ * moving it to the place of the root gives the fingerprint of the whole
+ * plane, the same however the tree is cut or collected.
+ */
+class HashLife {
+   public:
+    /*!@brief Start with an empty plane.
+     *@param Rule of the cells, without B0.
+     *@param Number of nodes above which the garbage is collected.
+     */
+    explicit HashLife(const Rule &rule = Rule(),
+                      std::size_t max_nodes = std::size_t(1) << 22);
+
+    /*!@brief Replace the plane by the visible cells of a grid.
+     *
+     * The cell (1, 1) of the grid is the cell (1, 1) of the plane.
+     */
+    void load(const Grid &grid);
+
+    //! Advance 2^k generations in one call.
+    void advance(int k);
+
+    //! Kill every cell of the grid and copy the window of the plane into it.
+    void render(Grid &grid) const;
+
+    //! Living cells in the whole plane.
+    long long population() const;
+
+    //! Fingerprint of the living cells of the whole plane.
+    Fingerprint fingerprint() const;
+
+    //! Nodes currently in the cache.
+    std::size_t nodes() const { return pool.size(); }
+
+   private:
+    using node_id = std::uint32_t;
+
+    //! Square of 2^level x 2^level cells. Levels 0 are the cells themselves.
+    struct Node {
+        node_id nw, ne, sw, se;  //!< Quadrants (level - 1).
+        node_id result;          //!< Centre, 2^result_k generations ahead.
+        int result_k;            //!< -1 while result was not computed.
+        int level;               //!< log2 of the side.
+        long long population;    //!< Living cells.
+        Fingerprint cells;       //!< Sums of x^i y^j, from the top left.
+    };
+
+    //! Quadrants of a node, the key of the canonical table.
+    struct Key {
+        node_id nw, ne, sw, se;
+
+        bool operator==(const Key &other) const {
+            return (nw == other.nw) && (ne == other.ne) && (sw == other.sw) &&
+                   (se == other.se);
+        }
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key &key) const;
+    };
+
+    //! The unique node with these quadrants.
+    node_id join(node_id nw, node_id ne, node_id sw, node_id se);
+
+    //! The node of the given level with no living cell.
+    node_id empty(int level);
+
+    //! Centre of a node, 2^j generations ahead (j <= level - 2).
+    node_id successor(node_id id, int j);
+
+    //! One generation of the centre 2x2 of a 4x4 node.
+    node_id base_step(const Node &node);
+
+    //! Surround the root with dead cells, doubling its side.
+    void expand();
+
+    //! Whether the living cells are in the central quarter of the root.
+    bool centred() const;
+
+    //! Build the node of the grid cells at (row, col) of the given level.
+    node_id build(const Grid &grid, std::int64_t row, std::int64_t col,
+                  int level);
+
+    //! Copy the living cells of a node at (row, col) into the grid.
+    void paint(node_id id, std::int64_t row, std::int64_t col,
+               Grid &grid) const;
+
+    //! Drop the nodes not reachable from the root.
+    void collect();
+
+    std::vector<Node> pool;                          //!< Every node.
+    std::unordered_map<Key, node_id, KeyHash> table;  //!< Canonical nodes.
+    std::vector<node_id> empties;  //!< Empty node of each level.
+    Rule rule;                     //!< Rule applied by base_step().
+    std::size_t max_nodes;         //!< Size that triggers collect().
+    node_id root = 0;              //!< The plane.
+    std::int64_t root_row = 1;     //!< Row of the top-left cell of root.
+    std::int64_t root_col = 1;     //!< Column of the top-left cell of root.
+};
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef IMAGE_WRITER_H
+#define IMAGE_WRITER_H
+
+// C
+#include <cstdint>  // std::uint8_t, std::uint32_t
+
+// C++
+#include <condition_variable>  // std::condition_variable
+#include <fstream>             // std::ofstream
+#include <mutex>               // std::mutex
+#include <string>              // std::string
+#include <thread>              // std::thread
+#include <vector>              // std::vector
+
+#include "grid.h"
+
+//! Color of a pixel.
+struct Color {
+    std::uint8_t r, g, b;
+};
+
+/*!@brief Look a color up by name (BLACK, BLUE, CRIMSON...).
+ *@return false if the name is unknown.
+ */
+bool find_color(const std::string &name, Color &color);
+
+/*!@brief Writes one image per generation on a background thread.
+ *
+ * submit() copies the cells into a spare grid and returns; the encoder thread
+ * turns the bit rows straight into a scanline of pixels, repeats it blocksize
+ * times and streams it to the file. PNG files use stored (uncompressed)
+ * deflate blocks, so they need no compression library. The grids and the
+ * scanline are reused from one image to the next.
+ */
+class ImageWriter {
+   public:
+    enum class Format { ppm, png };
+
+    /*!@brief Start the encoder thread.
+     *@param Directory of the images.
+     *@param File format.
+     *@param Pixel size of a cell.
+     *@param Color of the living cells.
+     *@param Color of the dead cells.
+     */
+    ImageWriter(const std::string &dir, Format format, int blocksize,
+                Color alive, Color background);
+
+    //! Write the images still queued and stop the encoder thread.
+    ~ImageWriter();
+
+    ImageWriter(const ImageWriter &) = delete;
+    ImageWriter &operator=(const ImageWriter &) = delete;
+
+    /*!@brief Queue the image of a generation.
+     *
+     * Only waits if the encoder is still busy with the image queued before.
+     *@return false if an image could not be written.
+     */
+    bool submit(const Grid &cells, long long gen);
+
+   private:
+    //! Loop of the encoder thread.
+    void work();
+
+    //! Write the image of `encoding`.
+    bool encode(long long gen);
+
+    //! Fill the scanline with the pixels of the row i of `encoding`.
+    void fill_scanline(int i);
+
+    //! Stream the image data of a PNG file, row by row.
+    void write_png_rows(std::ofstream &file);
+
+    std::string dir;     //!< Directory of the images, ending with '/'.
+    Format format;       //!< File format.
+    int blocksize;       //!< Pixel size of a cell.
+    Color alive;         //!< Color of the living cells.
+    Color background;    //!< Color of the dead cells.
+
+    Grid queued;                  //!< Cells waiting for the encoder.
+    Grid encoding;                //!< Cells being encoded.
+    long long queued_gen = 0;     //!< Generation of `queued`.
+    std::vector<std::uint8_t> scanline;  //!< Pixels of a row of the image.
+
+    std::thread thread;             //!< Encoder.
+    std::mutex lock;                //!< Protects the fields below.
+    std::condition_variable ready;  //!< Signals a new or a taken image.
+    bool has_queued = false;        //!< Whether `queued` holds an image.
+    bool failed = false;            //!< Whether an image could not be written.
+    bool stop = false;              //!< Ask the encoder to leave.
+};
+
+#endif
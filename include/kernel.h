@@ -0,0 +1,49 @@
+#ifndef KERNEL_H
+#define KERNEL_H
+
+// C
+#include <cstddef>  // std::size_t
+#include <cstdint>  // std::uint64_t
+
+// C++
+#include <string>  // std::string
+
+#include "grid.h"
+#include "rule.h"
+
+/*!@brief Block of a grid to advance one generation.
+ *
+ * Rows [row_begin, row_end) and words [word_begin, word_end) of the front
+ * grid are stepped into the back grid. The rows above and below the block and
+ * the words on its sides are only read.
+ */
+struct StepSpan {
+    const std::uint64_t *front;  //!< Row 0 of the current generation.
+    std::uint64_t *back;         //!< Row 0 of the next generation.
+    const std::uint64_t *mask;   //!< Visible columns of a row.
+    std::size_t stride;          //!< Words per row of both grids.
+    int row_begin, row_end;      //!< Rows to step.
+    std::size_t word_begin, word_end;  //!< Words of each row to step.
+    std::uint16_t birth, survive;  //!< Rule::birth and Rule::survive, only
+                                   //!< read by the any-rule kernels.
+};
+
+//! Step kernel: applies the rules to a block of the board.
+using step_kernel = void (*)(const StepSpan &span);
+
+/*!@brief Choose a step kernel by name.
+ *@param "auto" for the widest one the CPU supports, or one of "scalar",
+ * "sse2", "avx2" and "avx512".
+ *@param Whether the kernel must follow the rule of the span (any Life-like
+ * rule) rather than B3/S23.
+ *@return nullptr if the kernel is unknown or not supported by this CPU.
+ */
+step_kernel find_kernel(const std::string &name, bool any_rule = false);
+
+//! Name of the kernel "auto" resolves to on this CPU.
+std::string auto_kernel_name();
+
+//! Span covering all visible rows and words of a pair of grids, B3/S23.
+StepSpan full_span(const Grid &front, Grid &back);
+
+#endif
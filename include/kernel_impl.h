@@ -0,0 +1,245 @@
+#ifndef KERNEL_IMPL_H
+#define KERNEL_IMPL_H
+
+// Bit-parallel implementation of the rules, shared by the kernels compiled
+// for each instruction set. Only the translation units of the kernels should
+// include this file.
+
+#include "kernel.h"
+
+// Internal linkage: each kernel gets its own copy of the templates, compiled
+// for its own instruction set.
+namespace {
+
+//! Portable lane of 64 cells.
+struct ScalarOps {
+    using vec = std::uint64_t;
+    static const std::size_t lanes = 1;  //!< Words per vector.
+
+    static inline vec load(const std::uint64_t *p) { return *p; }
+    static inline void store(std::uint64_t *p, vec v) { *p = v; }
+    static inline vec bit_and(vec a, vec b) { return a & b; }
+    static inline vec bit_or(vec a, vec b) { return a | b; }
+    static inline vec bit_xor(vec a, vec b) { return a ^ b; }
+    static inline vec and_not(vec a, vec b) { return ~a & b; }
+    static inline vec shl1(vec a) { return a << 1; }
+    static inline vec shr1(vec a) { return a >> 1; }
+    static inline vec shl63(vec a) { return a << 63; }
+    static inline vec shr63(vec a) { return a >> 63; }
+};
+
+/*!@brief Next state of the cells of one vector of words, B3/S23.
+ *
+ * The eight neighbours are added with bitwise half/full adders, every bit
+ * position being an independent cell. `up`, `mid` and `down` point to the
+ * word w of the rows above, on and below the cells.
+ */
+template <class V>
+inline typename V::vec life_rule(const std::uint64_t *up,
+                                 const std::uint64_t *mid,
+                                 const std::uint64_t *down) {
+    using vec = typename V::vec;
+
+    // Column j - 1 is bit j of the left plane, column j + 1 of the right one.
+    // The bit crossing a word border comes from the (unaligned) neighbour.
+    auto left = [](const std::uint64_t *p, vec x) {
+        return V::bit_or(V::shl1(x), V::shr63(V::load(p - 1)));
+    };
+    auto right = [](const std::uint64_t *p, vec x) {
+        return V::bit_or(V::shr1(x), V::shl63(V::load(p + 1)));
+    };
+
+    const vec a = V::load(up), b = V::load(mid), c = V::load(down);
+    const vec al = left(up, a), ar = right(up, a);
+    const vec bl = left(mid, b), br = right(mid, b);
+    const vec cl = left(down, c), cr = right(down, c);
+
+    // Row above and row below: 2-bit sums (t1 t0) and (u1 u0).
+    const vec ax = V::bit_xor(al, a);
+    const vec t0 = V::bit_xor(ax, ar);
+    const vec t1 = V::bit_or(V::bit_and(al, a), V::bit_and(ar, ax));
+    const vec cx = V::bit_xor(cl, c);
+    const vec u0 = V::bit_xor(cx, cr);
+    const vec u1 = V::bit_or(V::bit_and(cl, c), V::bit_and(cr, cx));
+
+    // Same row, the cell itself excluded: (m1 m0).
+    const vec m0 = V::bit_xor(bl, br);
+    const vec m1 = V::bit_and(bl, br);
+
+    // Units of the total, and the carry into the twos.
+    const vec tu = V::bit_xor(t0, u0);
+    const vec s0 = V::bit_xor(tu, m0);
+    const vec c0 = V::bit_or(V::bit_and(t0, u0), V::bit_and(m0, tu));
+
+    // Total = s0 + 2 * k, k being how many of t1, u1, m1, c0 are set.
+    // 2 or 3 neighbours <=> k == 1.
+    const vec p = V::bit_xor(t1, u1), q = V::bit_xor(m1, c0);
+    const vec pq = V::bit_or(V::bit_and(t1, u1), V::bit_and(m1, c0));
+    const vec k1 = V::and_not(pq, V::bit_xor(p, q));
+
+    // Born with 3 neighbours, survive with 2 or 3.
+    return V::bit_and(k1, V::bit_or(s0, b));
+}
+
+//! Step a span, V::lanes words at a time and the remainder word by word.
+template <class V>
+void life_span(const StepSpan &span) {
+    using vec = typename V::vec;
+
+    for (int i = span.row_begin; i < span.row_end; i++) {
+        const std::uint64_t *mid = span.front + (std::size_t)i * span.stride;
+        const std::uint64_t *up = mid - span.stride;
+        const std::uint64_t *down = mid + span.stride;
+        std::uint64_t *out = span.back + (std::size_t)i * span.stride;
+
+        std::size_t w = span.word_begin;
+        for (; w + V::lanes <= span.word_end; w += V::lanes) {
+            const vec next = life_rule<V>(up + w, mid + w, down + w);
+            V::store(out + w, V::bit_and(next, V::load(span.mask + w)));
+        }
+
+        for (; w < span.word_end; w++) {
+            out[w] = life_rule<ScalarOps>(up + w, mid + w, down + w) &
+                     span.mask[w];
+        }
+    }
+}
+
+/*!@brief Neighbour counts of the Life-like rule of a span, found once per
+ *span: the counts 0..8 that give a living cell, for a dead cell (birth) and
+ *for a living one (survival).
+ */
+struct RuleTerms {
+    int counts[9];  //!< Counts in birth or survive.
+    bool born[9];   //!< Whether counts[k] is in birth.
+    bool kept[9];   //!< Whether counts[k] is in survive.
+    int size = 0;   //!< Number of counts.
+
+    explicit RuleTerms(const StepSpan &span) {
+        for (int n = 0; n <= 8; n++) {
+            if (((span.birth | span.survive) >> n) & 1) {
+                counts[size] = n;
+                born[size] = (span.birth >> n) & 1;
+                kept[size] = (span.survive >> n) & 1;
+                size++;
+            }
+        }
+    }
+};
+
+/*!@brief Next state of the cells of one vector of words, any Life-like rule.
+ *
+ * The same adders as life_rule() give the four bits of the number of
+ * neighbours (0 to 8); each count of the rule is then matched against those
+ * bits, with no branch on the cells.
+ */
+template <class V>
+inline typename V::vec any_rule(const std::uint64_t *up,
+                                const std::uint64_t *mid,
+                                const std::uint64_t *down,
+                                const RuleTerms &terms) {
+    using vec = typename V::vec;
+    static const std::uint64_t all_ones[8] = {~0ull, ~0ull, ~0ull, ~0ull,
+                                              ~0ull, ~0ull, ~0ull, ~0ull};
+
+    auto left = [](const std::uint64_t *p, vec x) {
+        return V::bit_or(V::shl1(x), V::shr63(V::load(p - 1)));
+    };
+    auto right = [](const std::uint64_t *p, vec x) {
+        return V::bit_or(V::shr1(x), V::shl63(V::load(p + 1)));
+    };
+
+    const vec a = V::load(up), b = V::load(mid), c = V::load(down);
+    const vec al = left(up, a), ar = right(up, a);
+    const vec bl = left(mid, b), br = right(mid, b);
+    const vec cl = left(down, c), cr = right(down, c);
+
+    // Row above, row below and same row: (t1 t0), (u1 u0) and (m1 m0).
+    const vec ax = V::bit_xor(al, a);
+    const vec t0 = V::bit_xor(ax, ar);
+    const vec t1 = V::bit_or(V::bit_and(al, a), V::bit_and(ar, ax));
+    const vec cx = V::bit_xor(cl, c);
+    const vec u0 = V::bit_xor(cx, cr);
+    const vec u1 = V::bit_or(V::bit_and(cl, c), V::bit_and(cr, cx));
+    const vec m0 = V::bit_xor(bl, br);
+    const vec m1 = V::bit_and(bl, br);
+
+    // Units, and the carry into the twos.
+    const vec tu = V::bit_xor(t0, u0);
+    const vec n0 = V::bit_xor(tu, m0);
+    const vec c0 = V::bit_or(V::bit_and(t0, u0), V::bit_and(m0, tu));
+
+    // Twos: t1 + u1 + m1 + c0 (0 to 4) = (n3 n2 n1).
+    const vec p = V::bit_xor(t1, u1), pc = V::bit_and(t1, u1);
+    const vec q = V::bit_xor(m1, c0), qc = V::bit_and(m1, c0);
+    const vec pq = V::bit_and(p, q);
+    const vec n1 = V::bit_xor(p, q);
+    const vec n2 = V::bit_xor(V::bit_xor(pc, qc), pq);
+    const vec n3 = V::bit_or(V::bit_and(pc, qc),
+                             V::bit_and(V::bit_xor(pc, qc), pq));
+
+    const vec ones = V::load(all_ones);
+    const vec bits[4] = {n0, n1, n2, n3};
+    const vec not_bits[4] = {V::and_not(n0, ones), V::and_not(n1, ones),
+                             V::and_not(n2, ones), V::and_not(n3, ones)};
+
+    vec born = V::bit_xor(a, a), kept = born;
+    for (int k = 0; k < terms.size; k++) {
+        const int n = terms.counts[k];
+        vec match = ((n & 1) ? bits[0] : not_bits[0]);
+        for (int bit = 1; bit < 4; bit++) {
+            match = V::bit_and(match, ((n >> bit) & 1) ? bits[bit]
+                                                       : not_bits[bit]);
+        }
+
+        if (terms.born[k]) {
+            born = V::bit_or(born, match);
+        }
+        if (terms.kept[k]) {
+            kept = V::bit_or(kept, match);
+        }
+    }
+
+    return V::bit_or(V::bit_and(b, kept), V::and_not(b, born));
+}
+
+//! Step a span with any Life-like rule, like life_span().
+template <class V>
+void any_rule_span(const StepSpan &span) {
+    using vec = typename V::vec;
+    const RuleTerms terms(span);
+
+    for (int i = span.row_begin; i < span.row_end; i++) {
+        const std::uint64_t *mid = span.front + (std::size_t)i * span.stride;
+        const std::uint64_t *up = mid - span.stride;
+        const std::uint64_t *down = mid + span.stride;
+        std::uint64_t *out = span.back + (std::size_t)i * span.stride;
+
+        std::size_t w = span.word_begin;
+        for (; w + V::lanes <= span.word_end; w += V::lanes) {
+            const vec next = any_rule<V>(up + w, mid + w, down + w, terms);
+            V::store(out + w, V::bit_and(next, V::load(span.mask + w)));
+        }
+
+        for (; w < span.word_end; w++) {
+            out[w] = any_rule<ScalarOps>(up + w, mid + w, down + w, terms) &
+                     span.mask[w];
+        }
+    }
+}
+
+}  // namespace
+
+// Kernels compiled for each instruction set, B3/S23 and any Life-like rule.
+void life_span_scalar(const StepSpan &span);
+void any_rule_span_scalar(const StepSpan &span);
+#if defined(__x86_64__) || defined(__i386__)
+void life_span_sse2(const StepSpan &span);
+void life_span_avx2(const StepSpan &span);
+void life_span_avx512(const StepSpan &span);
+void any_rule_span_sse2(const StepSpan &span);
+void any_rule_span_avx2(const StepSpan &span);
+void any_rule_span_avx512(const StepSpan &span);
+#endif
+
+#endif
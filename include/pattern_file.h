@@ -0,0 +1,92 @@
+#ifndef PATTERN_FILE_H
+#define PATTERN_FILE_H
+
+// C
+#include <cstddef>  // std::size_t
+
+// C++
+#include <string>  // std::string
+
+#include "grid.h"
+
+/*!@brief Pattern file mapped in memory, in one of the supported formats.
+ *
+ * - dat: "rows cols", the character of the living cells, then one line of
+ *   the board per row (the original format of glife).
+ * - rle: the run length encoded format of Golly and the LifeWiki.
+ * - life106: "#Life 1.06" then one "x y" line per living cell.
+ *
+ * RLE and Life 1.06 patterns have no board, so they are centred on a board
+ * with `margin` dead cells on each side.
+ */
+class PatternFile {
+   public:
+    enum class Format { dat, rle, life106 };
+
+    //! Dead cells around RLE and Life 1.06 patterns.
+    static const int margin = 32;
+
+    //! Most cells of a board (2^33, 1 GiB per grid of one bit per cell).
+    static const long long max_cells = 1LL << 33;
+
+    PatternFile() = default;
+
+    //! Unmap the file.
+    ~PatternFile();
+
+    PatternFile(const PatternFile &) = delete;
+    PatternFile &operator=(const PatternFile &) = delete;
+
+    /*!@brief Map a file, find its format and read its header.
+     *@return false if the file cannot be read, its header is invalid or
+     *its board too large.
+     */
+    bool open(const std::string &path);
+
+    //! Whether open() failed because the board has more than max_cells.
+    bool too_large() const { return oversized; }
+
+    //! Format of the file.
+    Format format() const { return fmt; }
+
+    //! Number of visible rows of the board.
+    int rows() const { return num_rows; }
+
+    //! Number of visible columns of the board.
+    int cols() const { return num_cols; }
+
+    //! Character of the living cells (dat), '*' for the other formats.
+    char cell_char() const { return alive; }
+
+    //! Rule given by the file (RLE "rule = "), empty if none.
+    const std::string &rule() const { return rule_name; }
+
+    /*!@brief Set the living cells of the pattern.
+     *@param Dead grid of rows() by cols() cells.
+     *@return false if the cells are invalid.
+     */
+    bool read(Grid &cells) const;
+
+   private:
+    bool open_dat();
+    bool open_rle();
+    bool open_life106();
+    bool read_dat(Grid &cells) const;
+    bool read_rle(Grid &cells) const;
+    bool read_life106(Grid &cells) const;
+
+    //! Set the size of the board, false if it is too large.
+    bool set_size(long long nRows, long long nCols);
+
+    const char *map = nullptr;  //!< Mapped file.
+    std::size_t size = 0;       //!< Bytes mapped.
+    std::size_t body = 0;       //!< Offset of the cells.
+    Format fmt = Format::dat;   //!< Format of the file.
+    int num_rows = 0, num_cols = 0;  //!< Size of the board.
+    char alive = '*';           //!< Character of the living cells (dat).
+    long long min_x = 0, min_y = 0;  //!< Top left cell (life106).
+    std::string rule_name;      //!< Rule of the pattern (rle).
+    bool oversized = false;     //!< The board was too large.
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef RULE_H
+#define RULE_H
+
+// C
+#include <cstdint>  // std::uint16_t, std::uint8_t
+
+// C++
+#include <string>  // std::string
+
+/*!@brief Life-like rule: the numbers of neighbours that give birth to a dead
+ *cell and those that keep a living cell alive.
+ *
+ * Compiled once into a 2x9 table, next[state][neighbours], for the per-cell
+ * code (reference kernel, HashLife); the bit-parallel kernels use the masks.
+ */
+struct Rule {
+    std::uint16_t birth = 1 << 3;                //!< Bit n: born with n.
+    std::uint16_t survive = (1 << 2) | (1 << 3);  //!< Bit n: survives with n.
+    std::uint8_t next[2][9];  //!< Next state by state and neighbours.
+
+    //! Conway's Life, B3/S23.
+    Rule() { compile(); }
+
+    //! Fill the table from the masks.
+    void compile();
+
+    //! Whether this is B3/S23, which has its own kernels.
+    bool is_life() const;
+
+    //! Name in B/S notation, as "B36/S23".
+    std::string name() const;
+};
+
+/*!@brief Parse a rule in B/S notation ("B36/S23", "b2/s") or in the older
+ *S/B notation ("23/36").
+ *@return false if the rule is invalid.
+ */
+bool parse_rule(const std::string &text, Rule &rule);
+
+#endif
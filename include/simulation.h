@@ -1,22 +1,46 @@
 #ifndef SIM_H
-#define Sim_H
+#define SIM_H
 
 // C
 #include <getopt.h>  // getopt()
-#include <unistd.h>  // usleep()
+#include <unistd.h>  // isatty(), STDOUT_FILENO
 
 #include <cstdlib>  // atoi()
 
 // C++
+#include <algorithm>  // std::min, std::max
+#include <chrono>     // std::chrono::steady_clock
 #include <fstream>    // std::ifstream
 #include <iomanip>    // std::setw, std::setfill
 #include <iostream>   // std::cout, std::cin
 #include <limits>     // std::numeric_limits
+#include <memory>     // std::unique_ptr
+#include <new>        // std::bad_alloc
 #include <sstream>    // std::ostringstream
 #include <stdexcept>  // std::invalid_argument
 #include <string>     // std::string
+#include <thread>     // std::this_thread::sleep_until
 #include <vector>     // std::vector
 
+#include "census.h"
+#include "checkpoint.h"
+#include "domain_workers.h"
+#include "fingerprint.h"
+#include "fingerprint_index.h"
+#include "gen_log.h"
+#include "grid.h"
+#include "hashlife.h"
+#include "image_writer.h"
+#include "kernel.h"
+#include "pattern_file.h"
+#include "sparse_board.h"
+#include "stats.h"
+#include "temporal_block.h"
+#include "terminal_renderer.h"
+#include "thread_pool.h"
+#include "tile_map.h"
+#include "tile_step.h"
+
 const int alive = 1;              //!< Alive cell.
 const int dead = 0;               //!< Dead cell.
 const int int_size = 2147483647;  //!< Standard value to maximum number of
@@ -24,14 +48,26 @@ const int int_size = 2147483647;  //!< Standard value to maximum number of
 
 class Simulation {
    private:
-    //! Save the coordinates for each cell.
-    struct Cell {
-        int x, y;  //!< Coordinates of the cell.
+    //! What is kept of the previous generations to detect stability.
+    enum class History {
+        none,          //!< Nothing, only extinction ends the simulation.
+        fingerprints,  //!< Fingerprints of the last fingerprint_window
+                       //!< generations and one for longer periods, a
+                       //!< 128-bit match is a repetition.
+        last,          //!< The last history_size generations, cells included.
+        full           //!< Every generation, cells included.
+    };
+
+    //! Generation whose cells are kept in log_master.
+    struct LoggedGeneration {
+        Grid cells;               //!< Living cells.
+        Fingerprint fingerprint;  //!< Key of the generation in `seen`.
+        long long gen;            //!< Number of the generation.
     };
 
     /// Save command line arguments.
     struct Options {
-        int maxgen = int_size;  //!< Maximum number of generations.
+        long long maxgen = int_size;  //!< Maximum number of generations.
         int fps = 2;            //!< Number of generations presented per second.
         int blocksize = 10;     //!< Pixel size of a cell.
         std::string alivecolor =
@@ -42,16 +78,90 @@ class Simulation {
         std::string inputfile;  //!< Filename for the input file.
         std::string outfile =
             "data/log.txt";  //!< Filename for the output file.
+        std::string kernel = "auto";  //!< Step kernel ("reference" = per cell).
+        int threads = 1;  //!< Number of threads stepping the generations.
+        std::string history =
+            "fingerprints";  //!< What is kept of previous generations.
+        std::string engine = "grid";  //!< Engine stepping the generations.
+        std::string boundary = "dead";  //!< What lies beyond the edges.
+        bool headless = false;  //!< Step as fast as possible, render rarely.
+        long long render_every = 0;  //!< Headless: generations between
+                                     //!< renders, 0 = only the last one.
+        int jump = 0;  //!< log2 of the generations per step (hashlife).
+        bool log = false;  //!< Record the generations in outfile.
+        bool images = false;  //!< Write an image per generation in imgdir.
+        std::string imgformat = "png";  //!< File format of the images.
+        std::string replay;  //!< Generation log to show instead of a run.
+        long long replay_gen = 1;  //!< Generation of the log to show.
+        long long checkpoint_every = 0;  //!< Generations between
+                                         //!< checkpoints, 0 = none.
+        std::string checkpoint =
+            "data/checkpoint.bin";  //!< Filename of the checkpoint.
+        std::string resume;  //!< Checkpoint to resume from.
+        std::string rule;    //!< Rule of the cells, empty = B3/S23.
+        bool stats = false;  //!< Report the stats to stderr.
+        std::string stats_file;  //!< File rewritten with the stats.
+        int workers = 1;  //!< Worker processes, 1 = step in this process.
+        int tblock = 1;   //!< Generations per pass over the board.
+        bool census = false;  //!< Count the objects of the last generation.
     } options;
 
-    using log_struct =
-        std::vector<Cell>;  //!< Store the coords for each generation.
-    std::vector<log_struct>
-        log_master;  //!< Store all generations from log_struct.
-    std::vector<std::vector<int>> petri_dish;  //!< Where the cells lives...
+    //! Generations whose fingerprints History::fingerprints keeps.
+    static const int fingerprint_window = 4096;
+
+    History history = History::fingerprints;  //!< Parsed options.history.
+    int history_size = 0;  //!< Generations kept by History::last.
+    std::vector<SnapshotEntry>
+        recent;  //!< Ring of the last generations, saved by checkpoints.
+    std::size_t recent_next = 0;  //!< Slot of recent replaced next.
+    SnapshotEntry far = {Fingerprint(), -1};  //!< Generation compared with
+                                              //!< for longer periods.
+    long long far_span = fingerprint_window;  //!< Generations before far
+                                              //!< moves on.
+    std::vector<LoggedGeneration>
+        log_master;        //!< Generations kept by the history.
+    int log_last = -1;     //!< Slot of log_master of the current generation.
+    Grid petri_dish;  //!< Where the cells lives... (front buffer). Empty
+                      //!< while the workers hold them and no output needs
+                      //!< them.
+    Grid next_dish;   //!< Where the next generation is built (back buffer).
+                      //!< Empty with worker processes.
     int num_rows, num_col;  //!< Dimensions of the petri_dish.
     char cell_char;         //!< Character that represent the cells.
-    int num_gen = 0;        //!< Number of generations.
+    long long num_gen = 0;  //!< Number of generations.
+    step_kernel kernel = nullptr;  //!< Bit-parallel rules, null = reference.
+    Rule rule;  //!< Parsed options.rule.
+    std::unique_ptr<ThreadPool> pool;  //!< Workers, null = single thread.
+    std::unique_ptr<HashLife> hashlife;  //!< HashLife engine, null = grid.
+    std::unique_ptr<SparseBoard> sparse;  //!< Tile map engine, null = grid.
+    std::unique_ptr<DomainWorkers>
+        domains;  //!< Worker processes holding the cells, null = none.
+    std::vector<GridDelta> band_deltas;  //!< Changes found by each worker.
+    std::unique_ptr<TemporalBlocker>
+        blocker;  //!< Steps options.tblock generations at once, or null.
+    int block_size = 0;  //!< Generations of the last block.
+    int block_used = 0;  //!< Generations of the block already counted.
+    Boundary boundary = Boundary::dead;  //!< Parsed options.boundary.
+    long long last_rendered = -1;  //!< Last generation shown by render().
+    std::unique_ptr<TerminalRenderer>
+        terminal;       //!< Redraws the changes, null = plain frames.
+    std::string frame;  //!< Plain frame being built.
+    std::string title;  //!< Title of the frame being built.
+    std::unique_ptr<GenLogWriter>
+        log_writer;  //!< Records the generations, null = no log.
+    std::unique_ptr<CheckpointWriter>
+        checkpoint_writer;  //!< Writes the checkpoints, null = none.
+    std::unique_ptr<ImageWriter>
+        image_writer;  //!< Encodes the images, null = no images.
+    std::unique_ptr<Stats> stats;  //!< Times the phases, null = no stats.
+    std::unique_ptr<Census> census;  //!< Counts the objects, null = none.
+    std::chrono::steady_clock::time_point
+        next_frame;  //!< When the next frame is due (interactive mode).
+    TileMap tiles;              //!< Tiles that changed and must be stepped.
+    long long active_tiles = 0;  //!< Tiles stepped in the last generation.
+    Fingerprint fingerprint;   //!< Hash of the current generation.
+    long long population = 0;  //!< Living cells in the current generation.
+    FingerprintIndex seen;  //!< Generations kept by the history.
 
    public:
     //! Default constructor
@@ -76,17 +186,30 @@ class Simulation {
      */
     bool game_over();
 
-    //! Apply the rules of conway's game of life, defining which cells will
-    //! live.
+    //! Apply the rules of conway's game of life, building the next
+    //! generation in the back buffer. HashLife jumps up to 2^jump
+    //! generations at once. With stats, a generation starts here.
     void process_events();
 
-    //! Update the petri_dish with the new generation, adding and removing
-    //! cells.
+    //! Swap the back buffer in as the current petri_dish and log it, with a
+    //! checkpoint every options.checkpoint_every generations. With worker
+    //! processes, the cells are gathered instead when needs_cells().
     void update();
 
-    //! Process the output (text and images).
+    /*!@brief Process the output (text and images).
+     *
+     * With --imgdir, every generation is also queued to the image writer.
+     * Interactive mode shows every generation and then waits for the next
+     * frame. Headless mode only shows every options.render_every
+     * generations.
+     */
     void render();
 
+    //! Show the last generation if render() skipped it (headless mode),
+    //! finish the generation log and report the stats of the run. A
+    //! temporal block is first stepped again up to the last generation.
+    void finish();
+
    private:
     /*!@brief Verify if the current generation is extinct.
      *@return true if not cell was stored in the log.
@@ -95,10 +218,31 @@ class Simulation {
 
     /*!@brief Verify if the current generation is equal to the previous
      *generations.
+     *
+     * Looks the fingerprint of the generation up in `seen`; the cells are
+     * only compared when the whole 128 bits match and the history kept them,
+     * so each call is O(1) on average. The current generation is then added
+     * to `seen` (see remember()).
+     *
+     * History::fingerprints only finds the periods up to fingerprint_window
+     * in `seen`; longer ones are found by Brent's cycle detection, which
+     * compares every generation with a single one, `far`, moved to the
+     * current generation after far_span generations, the span doubling
+     * each time. Such a period is found within about twice the generations
+     * it takes to enter the cycle, or the period itself.
      *@return true if the current generation is equal to a previous generation.
      */
     bool stable();
 
+    /*!@brief Add a generation to `seen`, with the cells of log_last if the
+     *history keeps them, and to the ring `recent`.
+     *
+     * History::fingerprints also forgets the generation leaving the ring,
+     * and moves `far` on if its span is over: its memory does not grow with
+     * the length of the run.
+     */
+    void remember(const Fingerprint &print, long long gen);
+
    private:
     /////////////////////////////////////////////
     // Get virtual values of the petri_dish
@@ -118,16 +262,64 @@ class Simulation {
     //! Prepare the petri_dish to store cells.
     void prepare_petri(int size_row, int size_col);
 
-    /*!@brief Check how many neighbors a cell has.
-     *@param Coordinate x of the cell.
-     *@param Coordinate y of the cell.
-     *@return Number of neighbors.
+    /*!@brief Define living cells applying the rules.
+     *
+     * The next state is written straight into next_dish by the selected
+     * kernel, or by the reference code without one (see step_tiles());
+     * petri_dish is left untouched.
      */
-    int surroundings(int i, int j);
-
-    //! Define living cells applying the rules.
     void set_alive();
 
+    /*!@brief Apply the rules to the active tiles of the band of a worker,
+     *and save the changes of fingerprint and population in band_deltas.
+     *@param Index of the band (worker).
+     */
+    void step_band(int band);
+
+    //! First row of tiles of the band stepped by a worker (band n ends at
+    //! n + 1).
+    int band_begin(int band);
+
+    /*!@brief Step a temporal block into next_dish, at most options.tblock
+     *generations and no further than options.maxgen.
+     *
+     * Each generation of the block is then counted by process_events()
+     * from the changes the blocker found, while petri_dish keeps the first
+     * generation; update() swaps the buffers after the last one.
+     */
+    void step_block_ahead();
+
+    /*!@brief Whether the cells of the current generation are shown or
+     *kept: the worker processes then have to send them.
+     */
+    bool needs_cells();
+
+    //! Number of workers stepping the generations.
+    inline int workers() { return pool ? pool->size() : 1; }
+
+    /*!@brief Keep a copy of the current petri_dish if the history needs it,
+     *and record it in the generation log.
+     *
+     * History::last reuses the slot of the oldest generation and drops that
+     * generation from `seen`.
+     */
+    void log_generation();
+
+    /*!@brief Hand a copy of the state over to the checkpoint writer: the
+     *cells, the ring `recent` and `far`, never more than fingerprint_window
+     *generations.
+     *
+     * A checkpoint still queued behind the one being written is replaced by
+     * this one, so the newest generation is always the next written and the
+     * simulation never waits for the disk.
+     */
+    void save_checkpoint();
+
+    /*!@brief Parse options.history.
+     *@return false if the policy is unknown.
+     */
+    bool parse_history();
+
     /////////////////////////////////////////////
     // I/O functions
     /////////////////////////////////////////////
@@ -139,10 +331,21 @@ class Simulation {
      */
     int read_options(int argc, char *argv[]);
 
-    /*!@brief Read the configuration file.
+    /*!@brief Read the configuration file: a .dat board, or an RLE or
+     *Life 1.06 pattern centred on a board (see PatternFile).
      */
     void read_file();
 
+    /*!@brief Restore the board, the generation, the last fingerprints seen
+     *and `far` from a checkpoint (--resume).
+     */
+    void load_resume();
+
+    /*!@brief Restore a generation of a generation log (--replay) into the
+     *petri_dish, seeking from the nearest keyframe.
+     */
+    void load_replay();
+
     /////////////////////////////////////////////
     // Print functions
     /////////////////////////////////////////////
@@ -156,9 +359,30 @@ class Simulation {
     //! Show the log.
     void print_log();
 
-    //! Show the petri_dish.
+    //! Append the petri_dish to the frame.
     void print_petri();
 
+    /*!@brief Show the number of the current generation and the petri_dish.
+     *
+     * The frame is built in a reused buffer and sent with a single write(2).
+     * On a terminal, the TerminalRenderer only redraws the changed cells.
+     */
+    void print_generation();
+
+    /*!@brief Show the objects of the current generation: still lifes,
+     *oscillators and spaceships, with their periods and counts.
+     */
+    void print_census();
+
+    /*!@brief Wait until the next frame is due, options.fps frames per
+     *second.
+     *
+     * The frames are due at fixed times of a steady clock, so the time spent
+     * stepping and rendering does not make the pace drift; after falling
+     * more than a frame behind, the schedule restarts from now.
+     */
+    void pace_frame();
+
     //! Show the arguments available from cli.
     void print_help();
 
@@ -0,0 +1,102 @@
+#ifndef SPARSE_BOARD_H
+#define SPARSE_BOARD_H
+
+// C
+#include <cstddef>  // std::size_t
+#include <cstdint>  // std::uint64_t, std::uint32_t, std::int64_t
+
+// C++
+#include <vector>  // std::vector
+
+#include "fingerprint.h"
+#include "grid.h"
+#include "kernel.h"
+#include "thread_pool.h"
+
+/*!@brief Unbounded plane stored as a hash table of 64x64 tiles.
+ *
+ * Only the tiles with living cells are kept: a tile appears when a cell is
+ * born in it and goes when its last cell dies, so the memory follows the
+ * population rather than the bounding box of the pattern. The tiles are
+ * packed in a vector, sorted by key, and found through an open-addressing
+ * index; the vectors keep their capacity from one generation to the next,
+ * so a step only allocates when the plane has more tiles than ever. The
+ * board of the simulation is a window into the plane, its cell (1, 1) being
+ * the cell (1, 1) of the plane.
+ *
+ * The fingerprint covers the whole plane: each row of a tile is hashed as
+ * the word of a grid at the same place would be, so it equals the one of
+ * the window while no cell lives outside. Each step XORs in the changes of
+ * the rows of the tiles it steps.
+ */
+class SparseBoard {
+   public:
+    static const int tile_side = 64;  //!< Rows and columns of a tile.
+
+    //! 64x64 cells, bit c of rows[r] being the column c of the row r.
+    struct Tile {
+        std::uint64_t rows[tile_side];
+    };
+
+    //! Use the given kernel to apply the rule (without B0) to each tile.
+    SparseBoard(step_kernel kernel, const Rule &rule);
+
+    //! Replace the plane by the visible cells of a grid.
+    void load(const Grid &grid);
+
+    //! Advance one generation, spreading the tiles over the workers if any.
+    void step(ThreadPool *pool);
+
+    //! Kill every cell of the grid and copy the window of the plane into it.
+    void render(Grid &grid) const;
+
+    //! Living cells in the whole plane.
+    long long population() const { return alive_cells; }
+
+    //! Fingerprint of the living cells of the whole plane.
+    Fingerprint fingerprint() const { return hash; }
+
+    //! Tiles currently allocated.
+    std::size_t tile_count() const { return keys.size(); }
+
+   private:
+    //! Key of the tile (ty, tx) in the map.
+    static std::uint64_t key(std::int64_t ty, std::int64_t tx);
+
+    //! Tile at the key, nullptr if it is not allocated (all dead).
+    const Tile *find(std::uint64_t k) const;
+
+    //! Rebuild the index of the tiles, after `keys` changed.
+    void index_tiles();
+
+    //! Next generation of a tile, and the change of the fingerprint.
+    struct Result {
+        Tile tile;          //!< Cells of the tile.
+        Fingerprint delta;  //!< XOR of the old and new fingerprints.
+        bool alive;         //!< Whether the tile has living cells.
+    };
+
+    /*!@brief Compute the next generation of one tile from it and its
+     *neighbours.
+     *@param Key of the tile.
+     *@param Where the next tile and the change of fingerprint are written.
+     */
+    void step_tile(std::uint64_t k, Result &next) const;
+
+    //! Tiles to step: the live ones, and their neighbours across the edges
+    //! that have living cells.
+    void find_candidates();
+
+    step_kernel kernel;                     //!< Rules, word by word.
+    Rule rule;                              //!< Rule of the kernel.
+    std::vector<std::uint64_t> keys;        //!< Keys of the live tiles.
+    std::vector<Tile> tiles;                //!< Live tiles, as `keys`.
+    std::vector<std::uint32_t> index;       //!< 1 + position in `tiles`
+                                            //!< by hash of the key, 0 = free.
+    std::vector<std::uint64_t> candidates;  //!< Keys stepped next.
+    std::vector<Result> results;            //!< Next tile of each candidate.
+    long long alive_cells = 0;              //!< Population.
+    Fingerprint hash;                       //!< Fingerprint of the plane.
+};
+
+#endif
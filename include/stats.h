@@ -0,0 +1,97 @@
+#ifndef STATS_H
+#define STATS_H
+
+// C++
+#include <chrono>  // std::chrono::steady_clock
+#include <string>  // std::string
+
+/*!@brief Times the phases of the generations and reports them every second.
+ *
+ * The loop of the simulation calls begin() once per generation and lap()
+ * after each phase: the time since the previous lap goes to that phase.
+ * Reading the clock costs about as much as stepping a small board, so only
+ * one generation in 64 is timed while the generations are short; the
+ * timings are averages over those. The report goes to stderr and/or to
+ * a file rewritten in place (Prometheus text format, renamed over the old
+ * one so a scraper never reads half of it).
+ */
+class Stats {
+   public:
+    //! Phases of a generation.
+    enum Phase {
+        step,    //!< Applying the rules (process_events).
+        update,  //!< Swapping the buffers, fingerprint and population.
+        io,      //!< Generation log, checkpoints and images.
+        render,  //!< Building and writing the frames.
+        wait,    //!< Waiting for the next frame (interactive mode).
+        check,   //!< Extinction and stability (game_over).
+        phases   //!< Number of phases.
+    };
+
+    /*!@brief Start the clock.
+     *@param Report to stderr.
+     *@param File rewritten with the report, empty = none.
+     */
+    Stats(bool to_stderr, const std::string &path);
+
+    /*!@brief Start a generation, ending the previous one; report if a
+     *second went by.
+     *@param Number of the generation.
+     *@param Living cells.
+     *@param Tiles stepped by the last generation.
+     */
+    void begin(long long gen, long long population, long long active_tiles);
+
+    //! Give the time since the previous lap to a phase.
+    void lap(Phase phase) {
+        if (timing) {
+            const clock::time_point now = clock::now();
+            phase_time[phase] += now - last_lap;
+            last_lap = now;
+        }
+    }
+
+    //! Report the last interval and a summary of the whole run, ending at
+    //! the given generation (same parameters as begin()).
+    void finish(long long gen, long long population, long long active_tiles);
+
+    //! Whether a report could not be written to the file.
+    bool failed() const { return write_failed; }
+
+   private:
+    using clock = std::chrono::steady_clock;
+
+    //! Report the interval since the last report.
+    void report(clock::time_point now);
+
+    //! Write the report to the file.
+    void write_file(double elapsed, double gens_per_sec);
+
+    bool to_stderr;    //!< Report to stderr.
+    std::string path;  //!< File of the report, empty = none.
+    bool write_failed = false;
+
+    clock::time_point started;      //!< Construction.
+    clock::time_point last_report;  //!< Last report, or started.
+    clock::time_point last_lap;     //!< Last lap of a timed generation.
+    clock::time_point sample_start;  //!< Start of the last timed one.
+    bool timing = false;            //!< The current generation is timed.
+    int stride = 1;                 //!< Generations per timed one.
+    long long counter = 0;          //!< Calls to begin().
+    long long sampled_at = 0;       //!< Counter of the last timed one.
+
+    long long gen = 0;           //!< Current generation.
+    long long population = 0;    //!< Its living cells.
+    long long active_tiles = 0;  //!< Tiles stepped by the last generation.
+    long long first_gen = -1;    //!< First generation seen.
+    long long report_gen = 0;    //!< Generation of the last report.
+
+    // Time of each phase over the timed generations, since the last report
+    // and since the start.
+    clock::duration phase_time[phases] = {};
+    clock::duration total_time[phases] = {};
+    long long timed = 0;        //!< Generations timed since the last report.
+    long long total_timed = 0;  //!< Generations timed since the start.
+};
+
+#endif
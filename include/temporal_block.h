@@ -0,0 +1,78 @@
+#ifndef TEMPORAL_BLOCK_H
+#define TEMPORAL_BLOCK_H
+
+// C
+#include <cstddef>  // std::size_t
+#include <cstdint>  // std::uint64_t
+
+// C++
+#include <vector>  // std::vector
+
+#include "fingerprint.h"
+#include "grid.h"
+#include "kernel.h"
+#include "rule.h"
+#include "thread_pool.h"
+
+/*!@brief Advances a dead-bounded grid several generations per pass over
+ *the memory (temporal blocking).
+ *
+ * The board is cut in tiles of tile_rows rows and tile_words words. Each
+ * tile is copied with a halo of k rows and one word on each side into a
+ * scratch pair that stays in the cache, stepped k generations there, and
+ * its own cells are copied out: the board is read and written once per k
+ * generations instead of once per generation. The cells of the halo go
+ * wrong from its outer edge inwards, one cell per generation, so the tile
+ * itself is exact for up to k generations (k <= 64, the width of the halo
+ * word).
+ *
+ * Each generation of each tile is compared with the previous one while in
+ * the cache, so the fingerprint and population of every generation of the
+ * block are known, as with a step per generation.
+ */
+class TemporalBlocker {
+   public:
+    static const int tile_rows = 512;  //!< Rows of a tile.
+    static const std::size_t tile_words = 64;  //!< Words of a tile row.
+    static const int max_generations = 64;  //!< Largest block.
+
+    /*!@brief Advance the front grid into the back grid.
+     *@param Current generation (only read).
+     *@param Receives the generation after the block.
+     *@param Generations of the block, 1 to max_generations.
+     *@param Kernel stepping the tiles.
+     *@param Rule of the cells.
+     *@param Workers sharing the rows of tiles, null = this thread.
+     */
+    void step(const Grid &front, Grid &back, int generations,
+              step_kernel kernel, const Rule &rule, ThreadPool *pool);
+
+    //! Changes made by generation t + 1 of the last block (t from 0).
+    const GridDelta &delta(int t) const { return deltas[t]; }
+
+   private:
+    //! Cache-resident copy of a tile, one per worker.
+    struct Scratch {
+        std::vector<std::uint64_t> cells[2];  //!< Two generations.
+        std::vector<std::uint64_t> mask;      //!< Visible columns.
+        std::vector<GridDelta> deltas;        //!< Changes per generation.
+    };
+
+    //! Step the rows of tiles of a worker.
+    void step_band(int worker, int workers);
+
+    //! Step a tile through the block.
+    void step_tile(Scratch &scratch, int ty, std::size_t tx);
+
+    // Block being stepped.
+    const Grid *front = nullptr;
+    Grid *back = nullptr;
+    int generations = 0;
+    step_kernel kernel = nullptr;
+    Rule rule;
+
+    std::vector<Scratch> scratch;   //!< Per worker.
+    std::vector<GridDelta> deltas;  //!< Changes per generation, all tiles.
+};
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef TERMINAL_RENDERER_H
+#define TERMINAL_RENDERER_H
+
+// C
+#include <cstddef>  // std::size_t
+
+// C++
+#include <string>  // std::string
+
+#include "grid.h"
+
+/*!@brief Write a whole buffer to a file descriptor with write(2).
+ *@return false if the write failed.
+ */
+bool write_all(int fd, const char *data, std::size_t size);
+
+/*!@brief Terminal renderer that only redraws what changed.
+ *
+ * The board is drawn at a fixed place of the screen. Each frame compares the
+ * grid with the previous one and, for each run of changed cells, moves the
+ * cursor there and writes the run. The frame is built in a buffer reused
+ * from one frame to the next and sent with a single write(2).
+ */
+class TerminalRenderer {
+   public:
+    /*!@brief Draw a frame on the standard output.
+     *@param Cells to show.
+     *@param Character of a living cell.
+     *@param Text of the line above the board.
+     */
+    void draw(const Grid &grid, char cell_char, const std::string &title);
+
+   private:
+    //! Move the cursor to a row and column of the screen (1-based).
+    void move_to(int row, int col);
+
+    //! Write the cells j0..j1 of the row i of the grid.
+    void draw_run(const Grid &grid, char cell_char, int i, int j0, int j1);
+
+    //! Clear the screen and draw the borders around an empty board.
+    void draw_borders(int rows, int cols);
+
+    Grid previous;       //!< Cells on the screen.
+    bool drawn = false;  //!< Whether previous is on the screen.
+    std::string buffer;  //!< Frame being built.
+};
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+// C++
+#include <condition_variable>  // std::condition_variable
+#include <functional>          // std::function
+#include <mutex>               // std::mutex
+#include <thread>              // std::thread
+#include <vector>              // std::vector
+
+/*!@brief Persistent workers that run the same task once per generation.
+ *
+ * The threads are created once and sleep between calls to run(), so stepping
+ * a generation costs a wake-up and a barrier instead of thread creation.
+ */
+class ThreadPool {
+   public:
+    //! Start nThreads - 1 workers, the caller of run() being worker 0.
+    explicit ThreadPool(int nThreads);
+
+    //! Stop and join the workers.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    //! Number of workers, the calling thread included.
+    int size() const { return (int)threads.size() + 1; }
+
+    /*!@brief Run task(worker) on every worker, worker 0 being the caller.
+     *
+     * Returns once all of them have finished (barrier), so everything the
+     * workers wrote is visible to the caller and to the next run().
+     */
+    void run(const std::function<void(int)> &task);
+
+   private:
+    //! Loop of the worker threads.
+    void work(int worker);
+
+    std::vector<std::thread> threads;  //!< Workers 1..size()-1.
+    std::mutex lock;                   //!< Protects the fields below.
+    std::condition_variable start;     //!< Signals a new round.
+    std::condition_variable done;      //!< Signals the end of a round.
+    const std::function<void(int)> *job = nullptr;  //!< Task of the round.
+    unsigned long round = 0;  //!< Number of rounds started.
+    int pending = 0;          //!< Workers still running the round.
+    bool stop = false;        //!< Ask the workers to leave.
+};
+
+#endif
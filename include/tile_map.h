@@ -0,0 +1,68 @@
+#ifndef TILE_MAP_H
+#define TILE_MAP_H
+
+// C
+#include <cstddef>  // std::size_t
+#include <cstdint>  // std::uint8_t
+
+// C++
+#include <vector>  // std::vector
+
+/*!@brief Activity of the tiles of a grid.
+ *
+ * A tile is tile_rows rows of one word (64 columns). A tile that did not
+ * change in the last step, and none of whose 8 neighbours did, cannot change
+ * in the next one: it is not stepped, the back buffer already holds its
+ * cells from two generations ago, which are the same.
+ */
+class TileMap {
+   public:
+    static const int tile_rows = 64;  //!< Rows of a tile.
+
+    //! Cover a grid of nRows visible rows and nWords words per row; every
+    //! tile starts as changed.
+    void resize(int nRows, std::size_t nWords);
+
+    /*!@brief Make the tiles on opposite edges neighbours (torus).
+     *@param Whether the board wraps around.
+     *@param Tile column holding the last visible column.
+     */
+    void set_wrap(bool wrap, std::size_t last_tx);
+
+    //! Mark every tile as changed, so all of them are stepped next.
+    void mark_all();
+
+    /*!@brief Find the tiles to step from the ones that changed.
+     *@return Number of active tiles.
+     */
+    long long activate();
+
+    //! Whether the tile must be stepped in this generation.
+    inline bool active(int ty, std::size_t tx) const {
+        return active_tiles[(std::size_t)ty * across + tx] != 0;
+    }
+
+    //! Record whether the tile changed in this generation.
+    inline void set_changed(int ty, std::size_t tx, bool changed) {
+        changed_tiles[(std::size_t)ty * across + tx] = changed;
+    }
+
+    //! Number of rows of tiles.
+    inline int tiles_down() const { return down; }
+
+    //! Number of tiles in a row of tiles.
+    inline std::size_t tiles_across() const { return across; }
+
+    //! First grid row of a row of tiles.
+    inline int first_row(int ty) const { return 1 + ty * tile_rows; }
+
+   private:
+    std::vector<std::uint8_t> changed_tiles;  //!< Changed in the last step.
+    std::vector<std::uint8_t> active_tiles;   //!< Stepped in the next one.
+    int down = 0;                              //!< Rows of tiles.
+    std::size_t across = 0;                    //!< Tiles per row of tiles.
+    bool wrap = false;                         //!< Torus.
+    std::size_t last = 0;  //!< Tile column of the last visible column.
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef TILE_STEP_H
+#define TILE_STEP_H
+
+#include "fingerprint.h"
+#include "grid.h"
+#include "kernel.h"
+#include "rule.h"
+#include "tile_map.h"
+
+/*!@brief Check how many neighbors a cell has, the reference way.
+ *@param Grid of the cells, halo filled.
+ *@param Row of the cell.
+ *@param Column of the cell.
+ *@return Number of neighbors.
+ */
+int surroundings(const Grid &grid, int i, int j);
+
+/*!@brief Apply the rules to the active tiles of a band of rows of tiles.
+ *
+ * Each run of active tiles of a row is stepped at once, then compared word
+ * by word while it is cached, which marks the tiles that changed and adds
+ * the changes of fingerprint and population to delta. The grid engine of
+ * glife and Engine both step their bands with it.
+ *@param Current generation, halo filled.
+ *@param Next generation.
+ *@param Tiles of the grids, activated.
+ *@param First row of tiles of the band.
+ *@param Row of tiles after the last one of the band.
+ *@param Bit-parallel rules, or null for the reference code, which counts
+ *the neighbors of each cell with surroundings() and looks the next state up
+ *in the table of the rule.
+ *@param Rule of the cells.
+ *@param Where the changes are added.
+ */
+void step_tiles(const Grid &front, Grid &back, TileMap &tiles, int ty_begin,
+                int ty_end, step_kernel kernel, const Rule &rule,
+                GridDelta &delta);
+
+#endif
@@ -0,0 +1,187 @@
+#include "../include/batch_runner.h"
+
+#include <algorithm>  // std::max, std::sort
+#include <cmath>      // std::sqrt
+#include <numeric>    // std::iota
+
+bool BatchRunner::load(const std::vector<Board> &boards,
+                       const EngineConfig &config) {
+    pool.reset();
+    slots.clear();
+    shelves.clear();
+    gen = 0;
+
+    if ((config.engine != "grid") || (config.boundary != Boundary::dead) ||
+        (config.threads < 1)) {
+        return false;
+    }
+
+    rule = config.rule;
+    kernel = find_kernel(config.kernel, !rule.is_life());
+    if (kernel == nullptr) {
+        return false;
+    }
+
+    if (config.threads > 1) {
+        pool.reset(new ThreadPool(config.threads));
+    }
+
+    // Width: about the side of a square holding every board and its
+    // gutters, in whole words, and at least the widest board.
+    double area = 0;
+    int widest = 0;
+    for (const Board &board : boards) {
+        area += (double)(board.rows() + 1) * (board.cols() + 1);
+        widest = std::max(widest, board.cols());
+    }
+    const int width =
+        (std::max(widest + 2, (int)std::sqrt(area) + 2) + 63) / 64 * 64 - 2;
+
+    // Shelves, highest boards first so that a shelf wastes few rows.
+    std::vector<int> order(boards.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&boards](int a, int b) {
+        return boards[a].rows() > boards[b].rows();
+    });
+
+    slots.resize(boards.size());
+    int row = 1, col = 1;
+    for (int index : order) {
+        const Board &board = boards[index];
+
+        if (shelves.empty() || (col + board.cols() - 1 > width)) {
+            if (!shelves.empty()) {
+                row = shelves.back().row_end + 1;  // Gutter row.
+            }
+            Shelf shelf;
+            shelf.row_begin = row;
+            shelf.row_end = row + board.rows();
+            shelf.words = 0;
+            shelves.push_back(shelf);
+            col = 1;
+        }
+
+        Slot &slot = slots[index];
+        slot.row = row;
+        slot.col = col;
+        slot.rows = board.rows();
+        slot.cols = board.cols();
+        slot.shelf = (int)shelves.size() - 1;
+        col += board.cols() + 1;  // Gutter column.
+    }
+
+    const int height = shelves.empty() ? 0 : shelves.back().row_end - 1;
+    front.resize(height, width);
+    back.resize(height, width);
+
+    for (Shelf &shelf : shelves) {
+        shelf.mask.assign(front.row_words(), 0);
+    }
+
+    for (std::size_t index = 0; index < boards.size(); index++) {
+        const Slot &slot = slots[index];
+        Shelf &shelf = shelves[slot.shelf];
+        const Grid &cells = boards[index].cells();
+
+        for (int j = slot.col; j < slot.col + slot.cols; j++) {
+            shelf.mask[j / 64] |= std::uint64_t(1) << (j % 64);
+        }
+        shelf.words = std::max(shelf.words,
+                               (std::size_t)(slot.col + slot.cols) / 64 + 1);
+
+        if (slot.row + slot.rows < shelf.row_end) {
+            shelf.short_slots.push_back((int)index);
+        }
+
+        for (int i = 1; i <= slot.rows; i++) {
+            for (int j = 1; j <= slot.cols; j++) {
+                if (cells.get(i, j)) {
+                    front.set(slot.row + i - 1, slot.col + j - 1, 1);
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+void BatchRunner::step(long long generations) {
+    for (long long g = 0; g < generations; g++) {
+        if (pool) {
+            pool->run([this](int worker) { step_shelves(worker); });
+        } else {
+            step_shelves(0);
+        }
+
+        front.swap(back);
+        gen++;
+    }
+}
+
+void BatchRunner::step_shelves(int worker) {
+    const std::size_t first = shelves.size() * worker / workers();
+    const std::size_t last = shelves.size() * (worker + 1) / workers();
+
+    StepSpan span = full_span(front, back);
+    span.birth = rule.birth;
+    span.survive = rule.survive;
+    span.word_begin = 0;
+
+    for (std::size_t s = first; s < last; s++) {
+        const Shelf &shelf = shelves[s];
+        span.mask = shelf.mask.data();
+        span.row_begin = shelf.row_begin;
+        span.row_end = shelf.row_end;
+        span.word_end = shelf.words;
+        kernel(span);
+
+        // Below a lower board, the rows of the shelf stay dead.
+        for (int index : shelf.short_slots) {
+            const Slot &slot = slots[index];
+            for (int i = slot.row + slot.rows; i < shelf.row_end; i++) {
+                clear_cells(i, slot.col, slot.col + slot.cols);
+            }
+        }
+    }
+}
+
+void BatchRunner::clear_cells(int i, int col_begin, int col_end) {
+    std::uint64_t *row = back.row(i);
+
+    for (int j = col_begin; j < col_end;) {
+        const int shift = j % 64;
+        const int n = std::min(64 - shift, col_end - j);
+        const std::uint64_t bits =
+            (n == 64) ? ~std::uint64_t(0) : ((std::uint64_t(1) << n) - 1);
+        row[j / 64] &= ~(bits << shift);
+        j += n;
+    }
+}
+
+Board BatchRunner::board(int index) const {
+    const Slot &slot = slots[index];
+    Board copy(slot.rows, slot.cols);
+
+    for (int i = 1; i <= slot.rows; i++) {
+        for (int j = 1; j <= slot.cols; j++) {
+            if (front.get(slot.row + i - 1, slot.col + j - 1)) {
+                copy.set(i, j, 1);
+            }
+        }
+    }
+
+    return copy;
+}
+
+long long BatchRunner::population(int index) const {
+    const Slot &slot = slots[index];
+    long long n = 0;
+
+    for (int i = slot.row; i < slot.row + slot.rows; i++) {
+        for (int j = slot.col; j < slot.col + slot.cols; j++) {
+            n += front.get(i, j);
+        }
+    }
+
+    return n;
+}
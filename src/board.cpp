@@ -0,0 +1,31 @@
+#include "../include/board.h"
+
+#include <new>  // std::bad_alloc
+
+#include "../include/pattern_file.h"
+
+Board::Board(int nRows, int nCols) : grid(nRows, nCols) {}
+
+bool Board::load(const std::string &path) {
+    PatternFile file;
+
+    if (!file.open(path)) {
+        return false;
+    }
+
+    Grid cells;
+    try {
+        cells.resize(file.rows(), file.cols());
+    } catch (const std::bad_alloc &) {
+        return false;  // Not enough memory for the board.
+    }
+
+    if (!file.read(cells)) {
+        return false;
+    }
+
+    grid.swap(cells);
+    rule_name = file.rule();
+
+    return true;
+}
@@ -0,0 +1,543 @@
+#include "../include/census.h"
+
+#include <algorithm>  // std::min, std::max, std::sort, std::lower_bound
+#include <cstdio>     // std::snprintf
+#include <utility>    // std::swap
+
+#include "../include/fingerprint.h"
+
+namespace {
+
+//! Common objects of B3/S23, in one of their phases.
+struct KnownObject {
+    const char *name;
+    std::vector<const char *> rows;  //!< '.' dead, 'O' alive.
+};
+
+const std::vector<KnownObject> &known_objects() {
+    static const std::vector<KnownObject> objects = {
+        {"block", {"OO", "OO"}},
+        {"beehive", {".OO.", "O..O", ".OO."}},
+        {"loaf", {".OO.", "O..O", ".O.O", "..O."}},
+        {"boat", {"OO.", "O.O", ".O."}},
+        {"ship", {"OO.", "O.O", ".OO"}},
+        {"tub", {".O.", "O.O", ".O."}},
+        {"pond", {".OO.", "O..O", "O..O", ".OO."}},
+        {"long boat", {"OO..", "O.O.", ".O.O", "..O."}},
+        {"barge", {".O..", "O.O.", ".O.O", "..O."}},
+        {"mango", {".OO..", "O..O.", ".O..O", "..OO."}},
+        {"blinker", {"OOO"}},
+        {"toad", {".OOO", "OOO."}},
+        {"beacon", {"OO..", "OO..", "..OO", "..OO"}},
+        {"pulsar",
+         {"..OOO...OOO..", ".............", "O....O.O....O",
+          "O....O.O....O", "O....O.O....O", "..OOO...OOO..",
+          ".............", "..OOO...OOO..", "O....O.O....O",
+          "O....O.O....O", "O....O.O....O", ".............",
+          "..OOO...OOO.."}},
+        {"pentadecathlon", {"..O....O..", "OO.OOOO.OO", "..O....O.."}},
+        {"glider", {".O.", "..O", "OOO"}},
+        {"LWSS", {".O..O", "O....", "O...O", "OOOO."}},
+        {"MWSS", {"...O..", ".O...O", "O.....", "O....O", "OOOOO."}},
+        {"HWSS", {"...OO..", ".O....O", "O......", "O.....O", "OOOOOO."}},
+    };
+    return objects;
+}
+
+/*!@brief Cells of the visible part of a grid, from the corner of their
+ *bounding box.
+ *@param Grid to read.
+ *@param Receives the cells.
+ *@param Receive the bounding box: column and row of its corner, width and
+ *height (all 0 if there is no living cell).
+ */
+template <typename Cell>
+void extract(const Grid &grid, std::vector<Cell> &cells, int &x0, int &y0,
+             int &w, int &h) {
+    int x1 = 0, y1 = 0;
+    x0 = y0 = w = h = 0;
+    cells.clear();
+
+    for (int i = 1; i <= grid.rows(); i++) {
+        const std::uint64_t *row = grid.row(i);
+
+        for (std::size_t word = 0; word < grid.row_words(); word++) {
+            std::uint64_t bits = row[word] & grid.interior_mask()[word];
+
+            while (bits != 0) {
+                const int j = (int)(word * 64) + __builtin_ctzll(bits);
+                bits &= bits - 1;
+
+                if (cells.empty()) {
+                    x0 = x1 = j;
+                    y0 = i;
+                }
+                x0 = std::min(x0, j);
+                x1 = std::max(x1, j);
+                y1 = i;
+
+                Cell cell;
+                cell.x = j;
+                cell.y = i;
+                cells.push_back(cell);
+            }
+        }
+    }
+
+    for (Cell &cell : cells) {
+        cell.x -= x0;
+        cell.y -= y0;
+    }
+
+    if (!cells.empty()) {
+        w = x1 - x0 + 1;
+        h = y1 - y0 + 1;
+    }
+}
+
+}  // namespace
+
+const char *kind_name(ObjectKind kind) {
+    switch (kind) {
+        case ObjectKind::still_life:
+            return "still life";
+        case ObjectKind::oscillator:
+            return "oscillator";
+        case ObjectKind::spaceship:
+            return "spaceship";
+        default:
+            return "other";
+    }
+}
+
+Census::Census(step_kernel kernel, const Rule &rule)
+    : kernel(kernel), rule(rule) {
+    if (rule.is_life()) {
+        name_objects();
+    }
+}
+
+void Census::list_living() {
+    living.clear();
+    row_at.assign((std::size_t)board->rows() + 2, 0);
+
+    for (int i = 1; i <= board->rows(); i++) {
+        const std::uint64_t *row = board->row(i);
+        row_at[i] = (std::int64_t)living.size();
+
+        for (std::size_t word = 0; word < board->row_words(); word++) {
+            std::uint64_t bits = row[word] & board->interior_mask()[word];
+
+            while (bits != 0) {
+                Cell cell;
+                cell.x = (int)(word * 64) + __builtin_ctzll(bits);
+                cell.y = i;
+                living.push_back(cell);
+                bits &= bits - 1;
+            }
+        }
+    }
+    row_at[board->rows() + 1] = (std::int64_t)living.size();
+}
+
+std::int64_t Census::find(std::int64_t cell) {
+    while (parent[cell] != cell) {
+        parent[cell] = parent[parent[cell]];
+        cell = parent[cell];
+    }
+    return cell;
+}
+
+void Census::unite(std::int64_t a, std::int64_t b) {
+    a = find(a);
+    b = find(b);
+
+    // The root is the first cell of the object in the order of the rows.
+    if (a < b) {
+        parent[b] = a;
+    } else if (b < a) {
+        parent[a] = b;
+    }
+}
+
+void Census::join_rows(std::int64_t cell, int from, int to) {
+    const int j = living[cell].x;
+
+    for (int r = from; r < to; r++) {
+        // The living cells of a row are in the order of their columns.
+        const auto end = living.begin() + row_at[r + 1];
+        auto near = std::lower_bound(
+            living.begin() + row_at[r], end, j - 2,
+            [](const Cell &other, int x) { return other.x < x; });
+
+        for (; (near != end) && (near->x <= j + 2); ++near) {
+            unite(cell, near - living.begin());
+        }
+    }
+}
+
+void Census::join_band(int band, int bands) {
+    const int top = band_top(band, bands);
+    const int bottom = band_top(band + 1, bands);
+
+    // Only the cells of the band are written: the bands share no entry.
+    for (std::int64_t cell = row_at[top]; cell < row_at[bottom]; cell++) {
+        const Cell &at = living[cell];
+        parent[cell] = cell;
+
+        // The cells before it: two rows above and two to the left.
+        join_rows(cell, std::max(top, at.y - 2), at.y);
+        for (std::int64_t left = cell - 1;
+             (left >= row_at[at.y]) && (living[left].x >= at.x - 2); left--) {
+            unite(cell, left);
+        }
+    }
+}
+
+void Census::join_seam(int row) {
+    // Only the first two rows of the band reach the band above.
+    const int last = std::min(row + 2, board->rows() + 1);
+    for (std::int64_t cell = row_at[row]; cell < row_at[last]; cell++) {
+        join_rows(cell, std::max(1, living[cell].y - 2), row);
+    }
+}
+
+std::uint64_t Census::shape_hash(const std::vector<Cell> &shape, int w,
+                                 int h) {
+    // A sum of mixed cells: the order of the cells does not matter.
+    std::uint64_t hash = mix64(((std::uint64_t)h << 32) | (std::uint32_t)w);
+    for (const Cell &cell : shape) {
+        hash += mix64((((std::uint64_t)cell.y << 32) | (std::uint32_t)cell.x) ^
+                      0x9e3779b97f4a7c15ULL);
+    }
+    return hash;
+}
+
+int Census::canonical(const std::vector<Cell> &shape, int w, int h,
+                      std::uint64_t &hash) {
+    int best = 0;
+
+    for (int o = 0; o < 8; o++) {
+        const bool flip_x = (o & 1) != 0, flip_y = (o & 2) != 0;
+        const bool swap = (o & 4) != 0;
+        const int ow = swap ? h : w, oh = swap ? w : h;
+
+        std::uint64_t turned =
+            mix64(((std::uint64_t)oh << 32) | (std::uint32_t)ow);
+        for (const Cell &cell : shape) {
+            const int x = flip_x ? w - 1 - cell.x : cell.x;
+            const int y = flip_y ? h - 1 - cell.y : cell.y;
+            const std::uint64_t tx = (std::uint32_t)(swap ? y : x);
+            const std::uint64_t ty = swap ? x : y;
+            turned += mix64(((ty << 32) | tx) ^ 0x9e3779b97f4a7c15ULL);
+        }
+
+        if ((o == 0) || (turned < hash)) {
+            hash = turned;
+            best = o;
+        }
+    }
+
+    return best;
+}
+
+void Census::orient(const std::vector<Cell> &shape, int w, int h,
+                    int orientation, std::vector<Cell> &cells) {
+    const bool flip_x = (orientation & 1) != 0;
+    const bool flip_y = (orientation & 2) != 0;
+    const bool swap = (orientation & 4) != 0;
+
+    cells.clear();
+    for (const Cell &cell : shape) {
+        const int x = flip_x ? w - 1 - cell.x : cell.x;
+        const int y = flip_y ? h - 1 - cell.y : cell.y;
+
+        Cell turned;
+        turned.x = swap ? y : x;
+        turned.y = swap ? x : y;
+        cells.push_back(turned);
+    }
+
+    std::sort(cells.begin(), cells.end(), [](const Cell &a, const Cell &b) {
+        return (a.y != b.y) ? (a.y < b.y) : (a.x < b.x);
+    });
+}
+
+void Census::orient_move(int orientation, bool back, int &dx, int &dy) {
+    // The mirrors come first, then the transposition: undone the other way.
+    const bool swap = (orientation & 4) != 0;
+    if (back && swap) {
+        std::swap(dx, dy);
+    }
+    if ((orientation & 1) != 0) {
+        dx = -dx;
+    }
+    if ((orientation & 2) != 0) {
+        dy = -dy;
+    }
+    if (!back && swap) {
+        std::swap(dx, dy);
+    }
+}
+
+const Census::Phase *Census::lookup(const std::vector<Cell> &shape, int w,
+                                    int h, std::uint64_t &key,
+                                    int &orientation) {
+    orientation = canonical(shape, w, h, key);
+
+    auto candidates = phases.equal_range(key);
+    if (candidates.first == candidates.second) {
+        return nullptr;
+    }
+
+    orient(shape, w, h, orientation, oriented);
+    for (auto phase = candidates.first; phase != candidates.second; ++phase) {
+        if (phase->second.cells == oriented) {
+            return &phase->second;
+        }
+    }
+
+    return nullptr;  // Another shape with the same hash.
+}
+
+const Census::Phase *Census::classify(const std::vector<Cell> &shape, int w,
+                                      int h, std::uint64_t key,
+                                      int orientation) {
+    // Room for the object to move or grow max_period cells each way.
+    const int margin = max_period + 2;
+    Grid front(h + 2 * margin, w + 2 * margin);
+    Grid back(h + 2 * margin, w + 2 * margin);
+    for (const Cell &cell : shape) {
+        front.set(margin + 1 + cell.y, margin + 1 + cell.x, 1);
+    }
+
+    CensusEntry entry;
+    entry.cells = (int)shape.size();
+    std::vector<std::uint64_t> keys(1, key);
+    std::vector<Phase> seen(1);
+    std::vector<int> turns(1, orientation);
+    orient(shape, w, h, orientation, seen[0].cells);
+    const std::uint64_t start = shape_hash(shape, w, h);
+
+    std::vector<Cell> phase;
+    for (int gen = 1; (kernel != nullptr) && (gen <= max_period); gen++) {
+        StepSpan span = full_span(front, back);
+        span.birth = rule.birth;
+        span.survive = rule.survive;
+        kernel(span);
+        front.swap(back);
+
+        int x0, y0, pw, ph;
+        extract(front, phase, x0, y0, pw, ph);
+        if (phase.empty() || (x0 == 1) || (y0 == 1) ||
+            (x0 + pw > front.cols()) || (y0 + ph > front.rows())) {
+            break;  // Died, or grew to the edge.
+        }
+
+        if ((pw == w) && (ph == h) && (phase.size() == shape.size()) &&
+            (shape_hash(phase, pw, ph) == start)) {
+            entry.period = gen;
+            entry.dx = x0 - (margin + 1);
+            entry.dy = y0 - (margin + 1);
+            entry.kind = ((entry.dx != 0) || (entry.dy != 0))
+                             ? ObjectKind::spaceship
+                             : ((gen == 1) ? ObjectKind::still_life
+                                           : ObjectKind::oscillator);
+            break;
+        }
+
+        std::uint64_t phase_key;
+        turns.push_back(canonical(phase, pw, ph, phase_key));
+        keys.push_back(phase_key);
+        seen.emplace_back();
+        orient(phase, pw, ph, turns.back(), seen.back().cells);
+        entry.cells = std::min(entry.cells, (int)phase.size());
+    }
+
+    if (entry.kind == ObjectKind::other) {
+        keys.resize(1);  // Only this shape is known to do that.
+        seen.resize(1);
+        entry.cells = (int)shape.size();
+    }
+
+    // Named after the smallest hash of its phases, whichever came first.
+    const std::uint64_t id = *std::min_element(keys.begin(), keys.end());
+    const char *prefixes[] = {"xs", "xp", "xq", "other"};
+    char name[64];
+    std::snprintf(name, sizeof(name), "%s%d_%08llx",
+                  prefixes[(int)entry.kind],
+                  (entry.kind == ObjectKind::still_life) ||
+                          (entry.kind == ObjectKind::other)
+                      ? entry.cells
+                      : entry.period,
+                  (unsigned long long)(id >> 32));
+    entry.name = name;
+
+    const int object = (int)table.size();
+    table.push_back(entry);
+    for (std::size_t p = 0; p < seen.size(); p++) {
+        // A phase may come back mirrored before the period.
+        auto same = phases.equal_range(keys[p]);
+        while ((same.first != same.second) &&
+               !(same.first->second.cells == seen[p].cells)) {
+            ++same.first;
+        }
+        if (same.first != same.second) {
+            continue;
+        }
+
+        // The move, seen from the orientation the phase is kept in.
+        seen[p].object = object;
+        seen[p].dx = entry.dx;
+        seen[p].dy = entry.dy;
+        orient_move(turns[p], false, seen[p].dx, seen[p].dy);
+        phases.emplace(keys[p], std::move(seen[p]));
+    }
+
+    return lookup(shape, w, h, key, orientation);
+}
+
+void Census::name_objects() {
+    std::vector<Cell> cells;
+
+    for (const KnownObject &known : known_objects()) {
+        const int h = (int)known.rows.size();
+        int w = 0;
+        cells.clear();
+
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; known.rows[y][x] != '\0'; x++) {
+                w = std::max(w, x + 1);
+                if (known.rows[y][x] == 'O') {
+                    Cell cell;
+                    cell.x = x;
+                    cell.y = y;
+                    cells.push_back(cell);
+                }
+            }
+        }
+
+        std::uint64_t key;
+        int orientation;
+        const Phase *phase = lookup(cells, w, h, key, orientation);
+        if (phase == nullptr) {
+            phase = classify(cells, w, h, key, orientation);
+        }
+        table[phase->object].name = known.name;
+    }
+}
+
+void Census::take(const Grid &grid, ThreadPool *pool) {
+    board = &grid;
+    list_living();
+    parent.resize(living.size());
+
+    // Each band joins its own cells, then the seams join the bands.
+    const int bands = pool ? pool->size() : 1;
+    if (pool) {
+        pool->run([this, bands](int band) { join_band(band, bands); });
+    } else {
+        join_band(0, 1);
+    }
+    for (int band = 1; band < bands; band++) {
+        join_seam(band_top(band, bands));
+    }
+
+    // A cell points to no later cell, and the root of an object is its first
+    // cell: in order, a root numbers the next object and any other cell takes
+    // the object its parent already holds.
+    std::int64_t objects = 0;
+    for (std::int64_t cell = 0; cell < (std::int64_t)living.size(); cell++) {
+        parent[cell] = (parent[cell] == cell) ? objects++
+                                              : parent[parent[cell]];
+    }
+
+    // Group the cells by object (counting sort).
+    first.assign((std::size_t)objects + 1, 0);
+    for (std::int64_t object : parent) {
+        first[(std::size_t)object + 1]++;
+    }
+    for (std::size_t o = 1; o < first.size(); o++) {
+        first[o] += first[o - 1];
+    }
+    members.resize(living.size());
+    for (std::size_t c = 0; c < living.size(); c++) {
+        members[first[(std::size_t)parent[c]]++] = living[c];
+    }
+    for (std::size_t o = first.size() - 1; o > 0; o--) {
+        first[o] = first[o - 1];
+    }
+    first[0] = 0;
+
+    sightings.clear();
+    for (std::int64_t o = 0; o < objects; o++) {
+        int x0 = grid.cols(), y0 = grid.rows(), x1 = 0, y1 = 0;
+        for (std::int64_t m = first[o]; m < first[o + 1]; m++) {
+            x0 = std::min(x0, members[m].x);
+            x1 = std::max(x1, members[m].x);
+            y0 = std::min(y0, members[m].y);
+            y1 = std::max(y1, members[m].y);
+        }
+
+        shape.clear();
+        for (std::int64_t m = first[o]; m < first[o + 1]; m++) {
+            Cell cell;
+            cell.x = members[m].x - x0;
+            cell.y = members[m].y - y0;
+            shape.push_back(cell);
+        }
+
+        const int w = x1 - x0 + 1, h = y1 - y0 + 1;
+        std::uint64_t key;
+        int orientation;
+        const Phase *phase = lookup(shape, w, h, key, orientation);
+        if (phase == nullptr) {
+            phase = classify(shape, w, h, key, orientation);
+        }
+
+        // The move of this one, on the board.
+        Sighting sighting;
+        sighting.object = phase->object;
+        sighting.dx = phase->dx;
+        sighting.dy = phase->dy;
+        orient_move(orientation, true, sighting.dx, sighting.dy);
+        sightings.push_back(sighting);
+    }
+
+    // One entry per object and way it goes.
+    std::sort(sightings.begin(), sightings.end(),
+              [](const Sighting &a, const Sighting &b) {
+                  if (a.object != b.object) {
+                      return a.object < b.object;
+                  }
+                  return (a.dx != b.dx) ? (a.dx < b.dx) : (a.dy < b.dy);
+              });
+
+    found.clear();
+    for (std::size_t s = 0; s < sightings.size(); s++) {
+        const Sighting &sighting = sightings[s];
+        if ((s == 0) || (sighting.object != sightings[s - 1].object) ||
+            (sighting.dx != sightings[s - 1].dx) ||
+            (sighting.dy != sightings[s - 1].dy)) {
+            found.push_back(table[sighting.object]);
+            found.back().dx = sighting.dx;
+            found.back().dy = sighting.dy;
+            found.back().count = 0;
+        }
+        found.back().count++;
+    }
+    std::sort(found.begin(), found.end(),
+              [](const CensusEntry &a, const CensusEntry &b) {
+                  if (a.count != b.count) {
+                      return a.count > b.count;
+                  }
+                  if (a.cells != b.cells) {
+                      return a.cells < b.cells;
+                  }
+                  if (a.name != b.name) {
+                      return a.name < b.name;
+                  }
+                  return (a.dx != b.dx) ? (a.dx < b.dx) : (a.dy < b.dy);
+              });
+    objects_total = objects;
+}
@@ -0,0 +1,240 @@
+#include "../include/checkpoint.h"
+
+#include <fcntl.h>   // open()
+#include <unistd.h>  // write(), fsync(), close()
+
+#include <algorithm>  // std::copy, std::equal
+#include <cerrno>     // errno, EINTR
+#include <cstdio>     // std::rename, std::remove
+#include <fstream>    // std::ifstream
+#include <limits>     // std::numeric_limits
+#include <new>        // std::bad_alloc
+
+#include "../include/pattern_file.h"
+
+namespace {
+
+const char magic[8] = {'G', 'L', 'I', 'F', 'E', 'C', 'K', 'P'};
+const std::uint32_t version = 3;
+
+struct SnapshotHeader {
+    char magic[8];          //!< magic.
+    std::uint32_t version;  //!< version.
+    std::uint32_t rows;     //!< Visible rows.
+    std::uint32_t cols;     //!< Visible columns.
+    std::uint32_t cell_char;  //!< Character of a living cell.
+    std::uint16_t birth;    //!< Rule::birth.
+    std::uint16_t survive;  //!< Rule::survive.
+    std::uint32_t boundary;  //!< Boundary, in the order of the enum.
+    std::uint64_t gen;      //!< Number of the generation.
+    std::uint64_t entries;  //!< Number of SnapshotEntry.
+    std::uint64_t far_lo;   //!< Fingerprint of Snapshot::far.
+    std::uint64_t far_hi;
+    std::int64_t far_gen;   //!< Snapshot::far.gen.
+    std::int64_t far_span;  //!< Snapshot::far_span.
+};
+
+//! Write all the bytes, retrying after signals and short writes.
+bool write_all(int fd, const void *data, std::size_t size) {
+    const char *bytes = (const char *)data;
+
+    while (size > 0) {
+        const ssize_t n = ::write(fd, bytes, size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += n;
+        size -= (std::size_t)n;
+    }
+
+    return true;
+}
+
+}  // namespace
+
+bool read_snapshot(const std::string &path, Snapshot &snapshot) {
+    std::ifstream file(path, std::ios::binary);
+    SnapshotHeader header;
+
+    if (!file.read((char *)&header, sizeof(header)) ||
+        !std::equal(magic, magic + 8, header.magic) ||
+        (header.version != version) || (header.rows == 0) ||
+        (header.cols == 0) ||
+        (header.boundary > (std::uint32_t)Boundary::mirror) ||
+        (header.birth >= (1 << 9)) || (header.survive >= (1 << 9)) ||
+        ((header.far_gen >= 0) && (header.far_span < 1))) {
+        return false;
+    }
+
+    // A corrupt header must not size the board nor the entries.
+    const std::uint32_t max_side = std::numeric_limits<int>::max();
+    if ((header.rows > max_side) || (header.cols > max_side) ||
+        ((std::uint64_t)header.rows * header.cols >
+         (std::uint64_t)PatternFile::max_cells)) {
+        return false;
+    }
+
+    // The entries come before the rows, and cannot pass the end of the file.
+    file.seekg(0, std::ios::end);
+    const std::uint64_t left = (std::uint64_t)file.tellg() - sizeof(header);
+    if (!file.seekg(sizeof(header)) ||
+        (header.entries > left / sizeof(SnapshotEntry))) {
+        return false;
+    }
+
+    try {
+        snapshot.seen.resize((std::size_t)header.entries);
+        snapshot.cells.resize((int)header.rows, (int)header.cols);
+    } catch (const std::bad_alloc &) {
+        return false;
+    }
+
+    snapshot.cell_char = (char)header.cell_char;
+    snapshot.rule.birth = header.birth;
+    snapshot.rule.survive = header.survive;
+    snapshot.rule.compile();
+    snapshot.boundary = (Boundary)header.boundary;
+    snapshot.gen = (long long)header.gen;
+    snapshot.far.fingerprint.lo = header.far_lo;
+    snapshot.far.fingerprint.hi = header.far_hi;
+    snapshot.far.gen = (long long)header.far_gen;
+    snapshot.far_span = (long long)header.far_span;
+    if (!file.read((char *)snapshot.seen.data(),
+                   snapshot.seen.size() * sizeof(SnapshotEntry))) {
+        return false;
+    }
+
+    Grid &cells = snapshot.cells;
+    const std::uint64_t *mask = cells.interior_mask();
+
+    for (int i = 1; i <= cells.rows(); i++) {
+        std::uint64_t *row = cells.row(i);
+        if (!file.read((char *)row, cells.row_words() * 8)) {
+            return false;
+        }
+
+        for (std::size_t w = 0; w < cells.row_words(); w++) {
+            row[w] &= mask[w];  // The halo stays dead.
+        }
+    }
+
+    return true;
+}
+
+CheckpointWriter::CheckpointWriter(const std::string &path) : path(path) {
+    thread = std::thread(&CheckpointWriter::work, this);
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stop = true;
+    }
+    ready.notify_all();
+    thread.join();
+}
+
+Snapshot *CheckpointWriter::spare() {
+    std::lock_guard<std::mutex> guard(lock);
+
+    // Not taken yet (the writer only takes it under the lock): take it back
+    // until submit(), the newer one replaces it.
+    has_queued = false;
+    return &queued;
+}
+
+void CheckpointWriter::submit() {
+    bool idle;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        has_queued = true;
+        idle = !busy;
+    }
+
+    // A busy writer looks for a queued snapshot before waiting again.
+    if (idle) {
+        ready.notify_all();
+    }
+}
+
+bool CheckpointWriter::failed() {
+    std::lock_guard<std::mutex> guard(lock);
+    return write_failed;
+}
+
+void CheckpointWriter::work() {
+    std::unique_lock<std::mutex> guard(lock);
+
+    for (;;) {
+        ready.wait(guard, [this] { return has_queued || stop; });
+
+        if (!has_queued) {
+            return;  // Stopped, every snapshot is written.
+        }
+
+        // The simulation may fill `queued` again while this one is written.
+        writing.cells.swap(queued.cells);  // Both keep their storage.
+        writing.seen.swap(queued.seen);
+        writing.cell_char = queued.cell_char;
+        writing.rule = queued.rule;
+        writing.boundary = queued.boundary;
+        writing.gen = queued.gen;
+        writing.far = queued.far;
+        writing.far_span = queued.far_span;
+        has_queued = false;
+        busy = true;
+
+        guard.unlock();
+        const bool ok = write();
+        guard.lock();
+
+        busy = false;
+        write_failed = write_failed || !ok;
+    }
+}
+
+bool CheckpointWriter::write() {
+    const std::string tmp = path + ".tmp";
+    const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+
+    SnapshotHeader header = {};
+    std::copy(magic, magic + 8, header.magic);
+    header.version = version;
+    header.rows = (std::uint32_t)writing.cells.rows();
+    header.cols = (std::uint32_t)writing.cells.cols();
+    header.cell_char = (unsigned char)writing.cell_char;
+    header.birth = writing.rule.birth;
+    header.survive = writing.rule.survive;
+    header.boundary = (std::uint32_t)writing.boundary;
+    header.gen = (std::uint64_t)writing.gen;
+    header.entries = writing.seen.size();
+    header.far_lo = writing.far.fingerprint.lo;
+    header.far_hi = writing.far.fingerprint.hi;
+    header.far_gen = writing.far.gen;
+    header.far_span = writing.far_span;
+
+    bool ok = write_all(fd, &header, sizeof(header)) &&
+              write_all(fd, writing.seen.data(),
+                        writing.seen.size() * sizeof(SnapshotEntry));
+    for (int i = 1; ok && (i <= writing.cells.rows()); i++) {
+        ok = write_all(fd, writing.cells.row(i),
+                       writing.cells.row_words() * 8);
+    }
+
+    // On disk before the rename, or a crash could leave an empty checkpoint.
+    ok = ok && (fsync(fd) == 0);
+    ok = (::close(fd) == 0) && ok;
+    if (!ok) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+
+    // The previous checkpoint is replaced at once, never half written.
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
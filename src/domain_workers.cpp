@@ -0,0 +1,345 @@
+#include "../include/domain_workers.h"
+
+// C
+#include <poll.h>        // poll()
+#include <sys/socket.h>  // socketpair(), send(), recv()
+#include <sys/wait.h>    // waitpid()
+#include <unistd.h>      // fork(), close(), _exit()
+
+#include <cerrno>   // errno
+#include <cstdlib>  // EXIT_SUCCESS
+#include <cstring>  // std::memcpy
+
+namespace {
+
+// Commands of the coordinator, one byte each.
+const char step_cmd = 's';    //!< Step, reply with a GridDelta.
+const char gather_cmd = 'g';  //!< Reply with the rows of the domain.
+const char quit_cmd = 'q';    //!< Exit.
+
+//! Send all bytes on a socket, false if the other end is gone.
+bool send_all(int fd, const void *data, std::size_t size) {
+    const char *bytes = static_cast<const char *>(data);
+
+    while (size > 0) {
+        const ssize_t sent = send(fd, bytes, size, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += sent;
+        size -= (std::size_t)sent;
+    }
+
+    return true;
+}
+
+//! Receive all bytes from a socket, false if the other end is gone.
+bool recv_all(int fd, void *data, std::size_t size) {
+    char *bytes = static_cast<char *>(data);
+
+    while (size > 0) {
+        const ssize_t got = recv(fd, bytes, size, 0);
+        if (got <= 0) {
+            if ((got < 0) && (errno == EINTR)) {
+                continue;
+            }
+            return false;
+        }
+        bytes += got;
+        size -= (std::size_t)got;
+    }
+
+    return true;
+}
+
+//! Link of a worker to a neighbour: its edge row goes out, the halo row
+//! of the neighbour comes in.
+struct HaloLink {
+    int fd;                        //!< Socket to the neighbour, -1 = none.
+    const char *out;               //!< Edge row.
+    char *in;                      //!< Halo row.
+    std::size_t sent, received;    //!< Bytes done.
+};
+
+/*!@brief Swap the edge rows with both neighbours at once.
+ *
+ * Every worker sends before it receives, so blocking sends of rows larger
+ * than the socket buffers would wait on each other; poll() interleaves
+ * them instead.
+ *@return false if a neighbour is gone.
+ */
+bool exchange(HaloLink *links, int count, std::size_t bytes) {
+    for (int l = 0; l < count; l++) {
+        links[l].sent = links[l].received = 0;
+    }
+
+    for (;;) {
+        struct pollfd fds[2];
+        HaloLink *polled[2];
+        int n = 0;
+
+        for (int l = 0; l < count; l++) {
+            HaloLink &link = links[l];
+            const short events = (link.sent < bytes ? POLLOUT : 0) |
+                                 (link.received < bytes ? POLLIN : 0);
+            if ((link.fd >= 0) && (events != 0)) {
+                fds[n].fd = link.fd;
+                fds[n].events = events;
+                fds[n].revents = 0;
+                polled[n++] = &link;
+            }
+        }
+
+        if (n == 0) {
+            return true;
+        }
+
+        if (poll(fds, n, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        for (int p = 0; p < n; p++) {
+            HaloLink &link = *polled[p];
+
+            if ((fds[p].revents & POLLOUT) && (link.sent < bytes)) {
+                const ssize_t sent =
+                    send(link.fd, link.out + link.sent, bytes - link.sent,
+                         MSG_NOSIGNAL | MSG_DONTWAIT);
+                if ((sent < 0) && (errno != EAGAIN) && (errno != EINTR)) {
+                    return false;
+                }
+                link.sent += (sent > 0) ? (std::size_t)sent : 0;
+            }
+
+            if ((fds[p].revents & (POLLIN | POLLHUP | POLLERR)) &&
+                (link.received < bytes)) {
+                const ssize_t got =
+                    recv(link.fd, link.in + link.received,
+                         bytes - link.received, MSG_DONTWAIT);
+                if ((got == 0) ||
+                    ((got < 0) && (errno != EAGAIN) && (errno != EINTR))) {
+                    return false;
+                }
+                link.received += (got > 0) ? (std::size_t)got : 0;
+            }
+        }
+    }
+}
+
+/*!@brief Body of a worker process: step the rows [row_begin, row_end) of
+ *the board on the commands of the coordinator.
+ *@param Board, as it was when the worker was forked; the worker frees its
+ *copy once the domain is out of it.
+ *@param First row of the domain.
+ *@param Row after the last one of the domain.
+ *@param Socket to the coordinator.
+ *@param Socket to the worker above, -1 = top of the board.
+ *@param Socket to the worker below, -1 = bottom of the board.
+ *@param Kernel stepping the domain.
+ *@param Rule of the cells.
+ */
+void run_worker(Grid &board, int row_begin, int row_end, int ctrl,
+                int up, int down, step_kernel kernel, const Rule &rule) {
+    const int rows = row_end - row_begin;
+    const std::size_t bytes = board.row_words() * sizeof(std::uint64_t);
+    Grid front(rows, board.cols()), back(rows, board.cols());
+
+    for (int i = 1; i <= rows; i++) {
+        std::memcpy(front.row(i), board.row(row_begin + i - 1), bytes);
+    }
+
+    // The pages of the rest of the board are still shared with the
+    // coordinator, which drops its own copy too.
+    const std::size_t words = board.row_words();
+    board = Grid();
+
+    for (;;) {
+        char cmd;
+        if (!recv_all(ctrl, &cmd, 1) || (cmd == quit_cmd)) {
+            return;
+        }
+
+        if (cmd == gather_cmd) {
+            for (int i = 1; i <= rows; i++) {
+                if (!send_all(ctrl, front.row(i), bytes)) {
+                    return;
+                }
+            }
+            continue;
+        }
+
+        // The edges of the board stay dead: their halo rows are never
+        // written.
+        HaloLink links[2] = {
+            {up, reinterpret_cast<const char *>(front.row(1)),
+             reinterpret_cast<char *>(front.row(0)), 0, 0},
+            {down, reinterpret_cast<const char *>(front.row(rows)),
+             reinterpret_cast<char *>(front.row(rows + 1)), 0, 0},
+        };
+        if (!exchange(links, 2, bytes)) {
+            return;
+        }
+
+        StepSpan span = full_span(front, back);
+        span.birth = rule.birth;
+        span.survive = rule.survive;
+        kernel(span);
+
+        // Positions in the fingerprint are rows of the whole board.
+        GridDelta delta;
+        add_block_delta(front, back, 1, rows + 1, 0, words, delta,
+                        row_begin - 1);
+        front.swap(back);
+
+        if (!send_all(ctrl, &delta, sizeof delta)) {
+            return;
+        }
+    }
+}
+
+}  // namespace
+
+DomainWorkers::~DomainWorkers() {
+    command(quit_cmd);
+
+    for (const Domain &domain : domains) {
+        close(domain.fd);
+        waitpid(domain.pid, nullptr, 0);
+    }
+}
+
+bool DomainWorkers::start(Grid &board, int workers, step_kernel kernel,
+                          const Rule &rule) {
+    if ((workers < 1) || (workers > board.rows()) || (kernel == nullptr)) {
+        return false;
+    }
+
+    rows = board.rows();
+    cols = board.cols();
+    row_words = board.row_words();
+
+    // ctrl[k]: coordinator (0) and worker k (1). halo[k]: worker k (0) and
+    // worker k + 1 (1).
+    std::vector<int> fds;
+    std::vector<int> ctrl(2 * workers), halo(2 * (workers - 1));
+    bool opened = true;
+    for (int k = 0; opened && (k < workers); k++) {
+        opened = socketpair(AF_UNIX, SOCK_STREAM, 0, &ctrl[2 * k]) == 0;
+        if (opened) {
+            fds.insert(fds.end(), &ctrl[2 * k], &ctrl[2 * k] + 2);
+        }
+
+        if (opened && (k + 1 < workers)) {
+            opened = socketpair(AF_UNIX, SOCK_STREAM, 0, &halo[2 * k]) == 0;
+            if (opened) {
+                fds.insert(fds.end(), &halo[2 * k], &halo[2 * k] + 2);
+            }
+        }
+    }
+
+    if (!opened) {
+        for (int fd : fds) {
+            close(fd);
+        }
+        return false;
+    }
+
+    bool started = true;
+    for (int k = 0; k < workers; k++) {
+        Domain domain;
+        domain.fd = ctrl[2 * k];
+        domain.row_begin = 1 + (int)((long long)board.rows() * k / workers);
+        domain.row_end =
+            1 + (int)((long long)board.rows() * (k + 1) / workers);
+
+        const int own = ctrl[2 * k + 1];
+        const int up = (k > 0) ? halo[2 * (k - 1) + 1] : -1;
+        const int down = (k + 1 < workers) ? halo[2 * k] : -1;
+
+        domain.pid = started ? fork() : -1;
+        if (domain.pid == 0) {
+            // Only its own sockets, so that a worker sees the others go.
+            for (int fd : fds) {
+                if ((fd != own) && (fd != up) && (fd != down)) {
+                    close(fd);
+                }
+            }
+            run_worker(board, domain.row_begin, domain.row_end, own, up, down,
+                       kernel, rule);
+            _exit(EXIT_SUCCESS);
+        }
+
+        if (domain.pid < 0) {
+            started = false;
+            close(domain.fd);
+        } else {
+            domains.push_back(domain);
+        }
+    }
+
+    // The worker ends belong to the workers.
+    for (int k = 0; k < workers; k++) {
+        close(ctrl[2 * k + 1]);
+        if (k + 1 < workers) {
+            close(halo[2 * k]);
+            close(halo[2 * k + 1]);
+        }
+    }
+
+    return started;
+}
+
+bool DomainWorkers::step(GridDelta &delta) {
+    if (!command(step_cmd)) {
+        return false;
+    }
+
+    delta = GridDelta();
+    for (const Domain &domain : domains) {
+        GridDelta part;
+        if (!recv_all(domain.fd, &part, sizeof part)) {
+            return false;
+        }
+        delta.fingerprint ^= part.fingerprint;
+        delta.population += part.population;
+    }
+
+    return true;
+}
+
+bool DomainWorkers::gather(Grid &board) {
+    if (!command(gather_cmd)) {
+        return false;
+    }
+
+    if ((board.rows() != rows) || (board.cols() != cols)) {
+        board.resize(rows, cols);
+    }
+
+    for (const Domain &domain : domains) {
+        for (int i = domain.row_begin; i < domain.row_end; i++) {
+            if (!recv_all(domain.fd, board.row(i),
+                          row_words * sizeof(std::uint64_t))) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool DomainWorkers::command(char cmd) {
+    bool sent = true;
+
+    for (const Domain &domain : domains) {
+        sent = send_all(domain.fd, &cmd, 1) && sent;
+    }
+
+    return sent;
+}
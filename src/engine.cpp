@@ -0,0 +1,126 @@
+#include "../include/engine.h"
+
+bool Engine::load(const Board &board, const EngineConfig &config) {
+    this->config = config;
+    kernel = nullptr;
+    pool.reset();
+    hashlife.reset();
+    sparse.reset();
+
+    const bool grid = config.engine == "grid";
+    if ((!grid && (config.engine != "sparse") &&
+         (config.engine != "hashlife")) ||
+        (config.threads < 1) || (config.jump < 0) || (config.jump > 62)) {
+        return false;
+    }
+
+    // The unbounded engines have no edges, and need empty space to stay
+    // empty.
+    if (!grid && ((config.boundary != Boundary::dead) ||
+                  (config.rule.birth & 1))) {
+        return false;
+    }
+
+    const bool any_rule = !config.rule.is_life();
+    kernel = find_kernel(grid ? config.kernel : "scalar", any_rule);
+    if (kernel == nullptr) {
+        return false;
+    }
+
+    if (config.threads > 1) {
+        pool.reset(new ThreadPool(config.threads));
+    }
+
+    front = board.cells();
+    back.resize(front.rows(), front.cols());
+    tiles.resize(front.rows(), front.row_words());
+    tiles.set_wrap(config.boundary == Boundary::torus,
+                   (std::size_t)front.cols() / 64);
+
+    if (config.engine == "hashlife") {
+        hashlife.reset(new HashLife(config.rule));
+        hashlife->load(front);
+    } else if (config.engine == "sparse") {
+        sparse.reset(new SparseBoard(kernel, config.rule));
+        sparse->load(front);
+    }
+
+    band_deltas.resize(workers());
+    hash = hashlife ? hashlife->fingerprint() : grid_fingerprint(front);
+    alive = front.population();
+    gen = 0;
+
+    return true;
+}
+
+void Engine::step(long long generations) {
+    if (generations <= 0) {
+        return;
+    }
+
+    if (hashlife) {
+        // Powers of two, up to 2^jump, that add up to the generations.
+        for (long long left = generations; left > 0;) {
+            int k = 0;
+            while ((k < config.jump) && ((2LL << k) <= left)) {
+                k++;
+            }
+            hashlife->advance(k);
+            left -= 1LL << k;
+        }
+
+        hashlife->render(front);
+        alive = hashlife->population();
+    } else if (sparse) {
+        for (long long g = 0; g < generations; g++) {
+            sparse->step(pool.get());
+        }
+
+        sparse->render(front);
+        alive = sparse->population();
+    } else {
+        for (long long g = 0; g < generations; g++) {
+            step_grid();
+        }
+    }
+
+    if (hashlife) {
+        hash = hashlife->fingerprint();
+    } else if (sparse) {
+        hash = sparse->fingerprint();
+    }
+    gen += generations;
+}
+
+void Engine::step_grid() {
+    front.fill_halo(config.boundary);
+    tiles.activate();
+
+    if (pool) {
+        pool->run([this](int worker) { step_band(worker); });
+    } else {
+        step_band(0);
+    }
+
+    front.swap(back);
+    for (const auto &delta : band_deltas) {
+        hash ^= delta.fingerprint;
+        alive += delta.population;
+    }
+}
+
+void Engine::step_band(int band) {
+    band_deltas[band] = GridDelta();
+    step_tiles(front, back, tiles, band_begin(band), band_begin(band + 1),
+               kernel, config.rule, band_deltas[band]);
+}
+
+int Engine::band_begin(int band) const {
+    return (int)((long long)tiles.tiles_down() * band / workers());
+}
+
+Board Engine::board() const {
+    Board copy(front.rows(), front.cols());
+    copy.cells() = front;
+    return copy;
+}
@@ -0,0 +1,46 @@
+#include "../include/fingerprint.h"
+
+Fingerprint grid_fingerprint(const Grid &grid) {
+    const std::uint64_t *mask = grid.interior_mask();
+    Fingerprint fp;
+
+    for (int i = 1; i <= grid.rows(); i++) {
+        const std::uint64_t *row = grid.row(i);
+
+        for (std::size_t w = 0; w < grid.row_words(); w++) {
+            fp ^= word_fingerprint(i, w, row[w] & mask[w]);
+        }
+    }
+
+    return fp;
+}
+
+bool add_block_delta(const Grid &front, const Grid &back, int row_begin,
+                     int row_end, std::size_t word_begin, std::size_t word_end,
+                     GridDelta &delta, int row_offset) {
+    const std::uint64_t *mask = front.interior_mask();
+    bool changed = false;
+
+    for (int i = row_begin; i < row_end; i++) {
+        const std::uint64_t *before = front.row(i);
+        const std::uint64_t *after = back.row(i);
+
+        for (std::size_t w = word_begin; w < word_end; w++) {
+            const std::uint64_t old_word = before[w] & mask[w];
+            const std::uint64_t new_word = after[w] & mask[w];
+
+            // Only the words that changed are hashed.
+            if (old_word != new_word) {
+                delta.fingerprint ^=
+                    word_fingerprint(i + row_offset, w, old_word);
+                delta.fingerprint ^=
+                    word_fingerprint(i + row_offset, w, new_word);
+                delta.population += __builtin_popcountll(new_word) -
+                                    __builtin_popcountll(old_word);
+                changed = true;
+            }
+        }
+    }
+
+    return changed;
+}
@@ -0,0 +1,84 @@
+#include "../include/fingerprint_index.h"
+
+void FingerprintIndex::reserve(std::size_t entries) {
+    std::size_t capacity = 16;
+    while (capacity < 2 * entries) {
+        capacity *= 2;
+    }
+
+    if (capacity > table.size()) {
+        rehash(capacity);
+    }
+}
+
+std::size_t FingerprintIndex::probe(const Fingerprint &fingerprint) const {
+    const std::size_t mask = table.size() - 1;
+
+    // The halves are already mixed: the low one is a good slot.
+    std::size_t i = (std::size_t)fingerprint.lo & mask;
+    while ((table[i].gen >= 0) && !(table[i].fingerprint == fingerprint)) {
+        i = (i + 1) & mask;
+    }
+
+    return i;
+}
+
+const FingerprintIndex::Entry *FingerprintIndex::find(
+    const Fingerprint &fingerprint) const {
+    if (count == 0) {
+        return nullptr;
+    }
+
+    const Entry &entry = table[probe(fingerprint)];
+    return (entry.gen >= 0) ? &entry : nullptr;
+}
+
+void FingerprintIndex::insert(const Entry &entry) {
+    if (2 * (count + 1) > table.size()) {
+        reserve(count + 1);
+    }
+
+    Entry &slot = table[probe(entry.fingerprint)];
+    if (slot.gen < 0) {
+        count++;
+    }
+    slot = entry;
+}
+
+bool FingerprintIndex::erase(const Fingerprint &fingerprint, long long gen) {
+    if (count == 0) {
+        return false;
+    }
+
+    const std::size_t mask = table.size() - 1;
+    std::size_t hole = probe(fingerprint);
+    if ((table[hole].gen < 0) || (table[hole].gen != gen)) {
+        return false;
+    }
+
+    // Move back the entries of the run that the hole would cut from their
+    // home slot.
+    for (std::size_t i = (hole + 1) & mask; table[i].gen >= 0;
+         i = (i + 1) & mask) {
+        const std::size_t home = (std::size_t)table[i].fingerprint.lo & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            table[hole] = table[i];
+            hole = i;
+        }
+    }
+
+    table[hole] = Entry();
+    count--;
+    return true;
+}
+
+void FingerprintIndex::rehash(std::size_t capacity) {
+    std::vector<Entry> old(capacity);
+    old.swap(table);
+
+    for (const Entry &entry : old) {
+        if (entry.gen >= 0) {
+            table[probe(entry.fingerprint)] = entry;
+        }
+    }
+}
@@ -6,7 +6,174 @@ void Simulation::initialize(int argc, char *argv[]) {
         exit(EXIT_FAILURE);
     }
 
-    read_file();  // Read the config file.
+    // Choose the step kernel.
+    if (options.kernel != "reference") {
+        kernel = find_kernel(options.kernel);
+
+        if (kernel == nullptr) {
+            std::cerr << "\n\033[0;31m>>> Error: kernel [" << options.kernel
+                      << "] is unknown or not supported by this CPU.\033[0m\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Choose what is kept of the previous generations.
+    if (!parse_history()) {
+        std::cerr << "\n\033[0;31m>>> Error: unknown history ["
+                  << options.history << "].\033[0m\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // Start the workers.
+    if (options.threads < 1) {
+        std::cerr << "\n\033[0;31m>>> Error: the number of threads must be "
+                     "positive.\033[0m\n";
+        exit(EXIT_FAILURE);
+    } else if (options.threads > 1) {
+        pool.reset(new ThreadPool(options.threads));
+    }
+
+    // Without frames per second, run as fast as possible.
+    if (options.fps < 0) {
+        std::cerr << "\n\033[0;31m>>> Error: the fps must not be "
+                     "negative.\033[0m\n";
+        exit(EXIT_FAILURE);
+    } else if (options.fps == 0) {
+        options.headless = true;
+    }
+
+    // Read the config file, the generation to replay, or the checkpoint
+    // (which also gives the rule and the boundary).
+    if (options.replay != "") {
+        load_replay();
+    } else if (options.resume != "") {
+        load_resume();
+    } else {
+        read_file();
+    }
+
+    // Choose the boundary condition.
+    if (options.boundary == "dead") {
+        boundary = Boundary::dead;
+    } else if (options.boundary == "torus") {
+        boundary = Boundary::torus;
+    } else if (options.boundary == "mirror") {
+        boundary = Boundary::mirror;
+    } else {
+        std::cerr << "\n\033[0;31m>>> Error: unknown boundary ["
+                  << options.boundary << "].\033[0m\n";
+        exit(EXIT_FAILURE);
+    }
+
+    if ((boundary != Boundary::dead) && (options.engine != "grid")) {
+        std::cerr << "\n\033[0;31m>>> Error: the " << options.engine
+                  << " engine has no boundary, it runs on an unbounded "
+                     "plane.\033[0m\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // Choose the rule; B3/S23 keeps its own kernels.
+    if ((options.rule != "") && !parse_rule(options.rule, rule)) {
+        std::cerr << "\n\033[0;31m>>> Error: invalid rule [" << options.rule
+                  << "].\033[0m\n";
+        exit(EXIT_FAILURE);
+    }
+
+    if ((kernel != nullptr) && !rule.is_life()) {
+        kernel = find_kernel(options.kernel, true);
+    }
+
+    // The unbounded engines need empty space to stay empty: no B0.
+    if ((rule.birth & 1) && (options.engine != "grid")) {
+        std::cerr << "\n\033[0;31m>>> Error: the " << options.engine
+                  << " engine cannot run a rule with B0.\033[0m\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // Changes on an edge of a torus reach the opposite edge.
+    tiles.set_wrap(boundary == Boundary::torus, (std::size_t)getNumCol() / 64);
+
+    // The HashLife engine starts from the cells of the board.
+    if (options.engine == "hashlife") {
+        if ((options.jump < 0) || (options.jump > 62)) {
+            std::cerr << "\n\033[0;31m>>> Error: the jump must be between 0 "
+                         "and 62.\033[0m\n";
+            exit(EXIT_FAILURE);
+        }
+
+        hashlife.reset(new HashLife(rule));
+        hashlife->load(petri_dish);
+    } else if (options.engine == "sparse") {
+        // One word per tile row: the scalar kernel is the one that fits.
+        sparse.reset(
+            new SparseBoard(find_kernel("scalar", !rule.is_life()), rule));
+        sparse->load(petri_dish);
+    } else if (options.engine != "grid") {
+        std::cerr << "\n\033[0;31m>>> Error: unknown engine ["
+                  << options.engine << "].\033[0m\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // Split the board between worker processes, before any other thread
+    // starts (pool threads are not an issue: a worker never uses them).
+    if (options.workers < 1) {
+        std::cerr << "\n\033[0;31m>>> Error: the number of workers must be "
+                     "positive.\033[0m\n";
+        exit(EXIT_FAILURE);
+    } else if ((options.workers > 1) && (options.replay == "")) {
+        if ((options.engine != "grid") || (boundary != Boundary::dead) ||
+            (kernel == nullptr) || (options.threads > 1)) {
+            std::cerr << "\n\033[0;31m>>> Error: worker processes need the "
+                         "grid engine, a dead boundary, a bit-parallel kernel "
+                         "and one thread each.\033[0m\n";
+            exit(EXIT_FAILURE);
+        }
+
+        // The workers step into their own bands: no back buffer here, nor a
+        // copy of it in every worker.
+        next_dish = Grid();
+
+        domains.reset(new DomainWorkers());
+        if (!domains->start(petri_dish, options.workers, kernel, rule)) {
+            std::cerr << "\n\033[0;31m>>> Error: could not start "
+                      << options.workers << " workers for "
+                      << getNumRows() << " rows.\033[0m\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Temporal blocking, when no generation inside a block is needed.
+    if ((options.tblock < 1) ||
+        (options.tblock > TemporalBlocker::max_generations)) {
+        std::cerr << "\n\033[0;31m>>> Error: the temporal block must be "
+                     "between 1 and "
+                  << TemporalBlocker::max_generations << ".\033[0m\n";
+        exit(EXIT_FAILURE);
+    } else if ((options.tblock > 1) && (options.replay == "")) {
+        if ((options.engine == "grid") && (boundary == Boundary::dead) &&
+            (kernel != nullptr) && !domains && options.headless &&
+            (options.render_every == 0) && !options.log && !options.images &&
+            (options.checkpoint_every == 0) &&
+            ((history == History::none) ||
+             (history == History::fingerprints))) {
+            blocker.reset(new TemporalBlocker());
+        } else {
+            std::cerr << ">>> Temporal blocking needs the grid engine, a dead "
+                         "boundary, a bit-parallel kernel, headless mode and "
+                         "no output of the inner generations: stepping one "
+                         "generation at a time.\n";
+        }
+    }
+
+    band_deltas.resize(workers());
+    if (hashlife) {
+        fingerprint = hashlife->fingerprint();
+    } else if (sparse) {
+        fingerprint = sparse->fingerprint();
+    } else {
+        fingerprint = grid_fingerprint(petri_dish);
+    }
+    population = petri_dish.population();
 
     if (options.maxgen == int_size) {
         std::cerr << ">>> Running simulation until extinction/stability is "
@@ -17,11 +184,116 @@ void Simulation::initialize(int argc, char *argv[]) {
                      "whichever comes first.\n";
     }
 
+    if (hashlife) {
+        std::cerr << ">>> Engine: hashlife, up to 2^" << options.jump
+                  << " generations per step, rule " << rule.name() << ".\n";
+    } else if (sparse) {
+        std::cerr << ">>> Engine: sparse tiles on " << options.threads
+                  << " thread(s), rule " << rule.name() << "\n";
+    } else if (domains) {
+        std::cerr << ">>> Step kernel: "
+                  << (options.kernel == "auto" ? auto_kernel_name()
+                                               : options.kernel)
+                  << " on " << domains->size() << " worker processes, rule "
+                  << rule.name() << "\n";
+    } else {
+        std::cerr << ">>> Step kernel: "
+                  << (options.kernel == "auto" ? auto_kernel_name()
+                                               : options.kernel)
+                  << " on " << options.threads << " thread(s), rule "
+                  << rule.name() << "\n";
+    }
+
+    // Start the image encoder.
+    if (options.images) {
+        Color alive_color, bkg_color;
+        ImageWriter::Format format = ImageWriter::Format::png;
+
+        if (!find_color(options.alivecolor, alive_color) ||
+            !find_color(options.bkgcolor, bkg_color)) {
+            std::cerr << "\n\033[0;31m>>> Error: unknown color ["
+                      << options.alivecolor << "] or [" << options.bkgcolor
+                      << "].\033[0m\n";
+            exit(EXIT_FAILURE);
+        }
+
+        if (options.imgformat == "ppm") {
+            format = ImageWriter::Format::ppm;
+        } else if (options.imgformat != "png") {
+            std::cerr << "\n\033[0;31m>>> Error: unknown image format ["
+                      << options.imgformat << "].\033[0m\n";
+            exit(EXIT_FAILURE);
+        }
+
+        if (options.blocksize < 1) {
+            std::cerr << "\n\033[0;31m>>> Error: the blocksize must be "
+                         "positive.\033[0m\n";
+            exit(EXIT_FAILURE);
+        }
+
+        image_writer.reset(new ImageWriter(options.imgdir, format,
+                                           options.blocksize, alive_color,
+                                           bkg_color));
+    }
+
+    // Start the checkpoint writer.
+    if (options.checkpoint_every < 0) {
+        std::cerr << "\n\033[0;31m>>> Error: the checkpoint interval must "
+                     "not be negative.\033[0m\n";
+        exit(EXIT_FAILURE);
+    } else if (options.checkpoint_every > 0) {
+        if (options.engine != "grid") {
+            std::cerr << "\n\033[0;31m>>> Error: checkpoints need the grid "
+                         "engine, the others have cells out of the "
+                         "board.\033[0m\n";
+            exit(EXIT_FAILURE);
+        }
+
+        checkpoint_writer.reset(new CheckpointWriter(options.checkpoint));
+    }
+
+    // Start the generation log.
+    if (options.log) {
+        log_writer.reset(new GenLogWriter(options.outfile));
+
+        if (!log_writer->is_open()) {
+            std::cerr << "\n\033[0;31m>>> Error: could not create ["
+                      << options.outfile << "].\033[0m\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // The census keeps its table of objects for the whole run.
+    if (options.census) {
+        census.reset(new Census(find_kernel("auto", !rule.is_life()), rule));
+    }
+
+    // Time the phases of the generations.
+    if (options.stats || (options.stats_file != "")) {
+        stats.reset(new Stats(options.stats, options.stats_file));
+    }
+
+    // Animate in place on a terminal, plain frames otherwise (pipes, files).
+    if (!options.headless && isatty(STDOUT_FILENO)) {
+        terminal.reset(new TerminalRenderer());
+    }
+
+    // The workers hold the cells: gather() brings them back when the output
+    // needs them.
+    if (domains && !needs_cells()) {
+        petri_dish = Grid();
+    }
+
     print_initial_msg();  // Print welcome message.
-    set_alive();          // Set living cells.
+    log_generation();    // Log the initial generation.
 }
 
 bool Simulation::game_over() {
+    // A replay shows a single generation.
+    if (options.replay != "") {
+        return true;
+    }
+
     // Check if the number of generations reached the max.
     if (num_gen >= (options.maxgen - 1)) {
         return true;
@@ -36,64 +308,202 @@ bool Simulation::game_over() {
 }
 
 void Simulation::process_events() {
-    ++num_gen;    // Upgrade the number of generations.
-    set_alive();  // Set living cells.
+    if (stats) {
+        stats->begin(num_gen, population,
+                     sparse ? (long long)sparse->tile_count() : active_tiles);
+
+        if (stats->failed()) {
+            std::cerr << "\n\033[0;31m>>> Error: could not write ["
+                      << options.stats_file << "].\033[0m\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (hashlife) {
+        // Largest power of two up to 2^jump that does not pass maxgen.
+        const long long left = options.maxgen - 1 - num_gen;
+        int k = 0;
+        while ((k < options.jump) && ((2LL << k) <= left)) {
+            k++;
+        }
+
+        hashlife->advance(k);
+        hashlife->render(next_dish);
+        num_gen += 1LL << k;
+    } else if (sparse) {
+        ++num_gen;  // Upgrade the number of generations.
+        sparse->step(pool.get());
+        sparse->render(next_dish);
+    } else if (blocker) {
+        if (block_used == block_size) {
+            step_block_ahead();
+        }
+
+        ++num_gen;  // Upgrade the number of generations.
+        band_deltas.assign(band_deltas.size(), GridDelta());
+        band_deltas[0] = blocker->delta(block_used++);
+    } else if (domains) {
+        ++num_gen;  // Upgrade the number of generations.
+
+        if (!domains->step(band_deltas[0])) {
+            std::cerr << "\n\033[0;31m>>> Error: a worker process "
+                         "stopped.\033[0m\n";
+            exit(EXIT_FAILURE);
+        }
+    } else {
+        ++num_gen;    // Upgrade the number of generations.
+        set_alive();  // Set living cells.
+    }
+
+    if (stats) {
+        stats->lap(Stats::step);
+    }
 }
 
 void Simulation::update() {
-    auto prev_gen = (num_gen - 1);  // Previous generation.
+    if (domains) {
+        // The workers hold the new generation.
+        if (needs_cells() && !domains->gather(petri_dish)) {
+            std::cerr << "\n\033[0;31m>>> Error: a worker process "
+                         "stopped.\033[0m\n";
+            exit(EXIT_FAILURE);
+        }
+    } else if (!blocker || (block_used == block_size)) {
+        // The back buffer holds the new generation, the old one is reused
+        // next.
+        petri_dish.swap(next_dish);
+    }
+
+    if (hashlife) {
+        // Cells out of the window still count, in both.
+        fingerprint = hashlife->fingerprint();
+        population = hashlife->population();
+    } else if (sparse) {
+        fingerprint = sparse->fingerprint();
+        population = sparse->population();
+    } else {
+        for (const auto &delta : band_deltas) {
+            fingerprint ^= delta.fingerprint;
+            population += delta.population;
+        }
+    }
+
+    if (stats) {
+        stats->lap(Stats::update);
+    }
+
+    log_generation();
+
+    if (checkpoint_writer && (num_gen % options.checkpoint_every == 0)) {
+        save_checkpoint();
+    }
+
+    if (stats) {
+        stats->lap(Stats::io);
+    }
+}
+
+void Simulation::render() {
+    // Every generation gets its image, whatever is shown.
+    if (image_writer && !image_writer->submit(petri_dish, num_gen + 1)) {
+        std::cerr << "\n\033[0;31m>>> Error: could not write the images "
+                     "in ["
+                  << options.imgdir << "].\033[0m\n";
+        exit(EXIT_FAILURE);
+    }
+
+    if (stats) {
+        stats->lap(Stats::io);
+    }
+
+    if (options.headless) {
+        // Every render_every generations, finish() shows the last one.
+        if ((options.render_every == 0) ||
+            ((last_rendered >= 0) &&
+             (num_gen - last_rendered < options.render_every))) {
+            return;
+        }
+    }
+
+    print_generation();
 
-    // Search by cell in the previous generation.
-    // If not found, kill cell (yeah!).
-    for (int i = 0; i < (int)log_master[prev_gen].size(); i++) {
-        auto idx_x_prev = log_master[prev_gen][i].x;
-        auto idx_y_prev = log_master[prev_gen][i].y;
-        bool found = false;
+    if (stats) {
+        stats->lap(Stats::render);
+    }
 
-        for (int j = 0; j < (int)log_master[num_gen].size(); j++) {
-            auto idx_x_curr = log_master[num_gen][j].x;
-            auto idx_y_curr = log_master[num_gen][j].y;
+    if (!options.headless) {
+        pace_frame();
 
-            if ((idx_x_prev == idx_x_curr) && (idx_y_prev == idx_y_curr)) {
-                found = true;
-                break;
-            }
+        if (stats) {
+            stats->lap(Stats::wait);
         }
+    }
+}
 
-        // Kill cell.
-        if (!found) {
-            petri_dish[idx_x_prev][idx_y_prev] = dead;
+void Simulation::finish() {
+    // The stats end with the last generation, before the final output.
+    if (stats) {
+        stats->finish(num_gen, population,
+                      sparse ? (long long)sparse->tile_count() : active_tiles);
+
+        if (stats->failed()) {
+            std::cerr << "\n\033[0;31m>>> Error: could not write ["
+                      << options.stats_file << "].\033[0m\n";
+            exit(EXIT_FAILURE);
         }
     }
 
-    // Define the living cells.
-    for (int i = 0; i < (int)log_master.size(); i++) {
-        for (int j = 0; j < (int)log_master[num_gen].size(); j++) {
-            auto idx_x = log_master[num_gen][j].x;
-            auto idx_y = log_master[num_gen][j].y;
+    // Ended inside a temporal block: step up to the last generation.
+    if (blocker && (block_used < block_size)) {
+        blocker->step(petri_dish, next_dish, block_used, kernel, rule,
+                      pool.get());
+        petri_dish.swap(next_dish);
+        block_size = block_used;
+    }
 
-            petri_dish[idx_x][idx_y] = alive;
+    if (last_rendered != num_gen) {
+        if (domains && !domains->gather(petri_dish)) {
+            std::cerr << "\n\033[0;31m>>> Error: a worker process "
+                         "stopped.\033[0m\n";
+            exit(EXIT_FAILURE);
         }
+        print_generation();
+    }
+
+    if (options.census) {
+        print_census();
+    }
+
+    // Let the last checkpoint reach the disk.
+    if (checkpoint_writer) {
+        checkpoint_writer.reset();
+    }
+
+    if (log_writer && !log_writer->close()) {
+        std::cerr << "\n\033[0;31m>>> Error: could not write ["
+                  << options.outfile << "].\033[0m\n";
+        exit(EXIT_FAILURE);
     }
 }
 
-void Simulation::render() {
-    // Print the index of the current generation.
-    if (options.maxgen == int_size) {
-        std::cout << "Generation [" << (num_gen + 1) << "]:["
-                  << "\u221E]" << std::endl;
-    } else {
-        std::cout << "Generation [" << (num_gen + 1) << "]:[" << options.maxgen
-                  << "]" << std::endl;
+void Simulation::pace_frame() {
+    using clock = std::chrono::steady_clock;
+    const auto period = std::chrono::duration_cast<clock::duration>(
+        std::chrono::duration<double>(1.0 / options.fps));
+    const auto now = clock::now();
+
+    // First frame, or more than a frame late: restart the schedule.
+    if ((next_frame == clock::time_point()) || (now - next_frame > period)) {
+        next_frame = now;
     }
 
-    print_petri();  // Show the petri_dish.
-    std::cout << std::endl;
+    next_frame += period;
+    std::this_thread::sleep_until(next_frame);
 }
 
 bool Simulation::extinct() {
-    // Verify if not exists living cells from log.
-    if (log_master[num_gen].size() == 0) {
+    // Verify if not exists living cells in the current generation.
+    if (population == 0) {
         std::cerr
             << "\033[0;31m>>> Simulation ended due to extinction. \033[0m\n\n";
         return true;
@@ -103,32 +513,39 @@ bool Simulation::extinct() {
 }
 
 bool Simulation::stable() {
+    if (history == History::none) {
+        return false;
+    }
+
     // Verify if the current generation is equal to a previous generation.
-    for (auto i = 0; i < num_gen; i++) {
-        bool equal = true;
+    const FingerprintIndex::Entry *prev = seen.find(fingerprint);
 
-        for (auto j = 0; j < (int)log_master[num_gen].size(); j++) {
-            if (log_master[i].size() == log_master[num_gen].size()) {
-                if ((log_master[i][j].x != log_master[num_gen][j].x) &&
-                    (log_master[i][j].y != log_master[num_gen][j].y)) {
-                    equal = false;
-                    break;
-                }
+    // History::last forgets the fingerprints restored from a checkpoint
+    // (without a slot) as it forgets its own generations: an expired entry
+    // is replaced below.
+    const bool expired = (prev != nullptr) && (history == History::last) &&
+                         (num_gen - prev->gen > history_size);
 
-            } else {
-                equal = false;
-                break;
-            }
-        }
+    // Without the cells, a 128-bit match is taken as a repetition.
+    long long repeated = -1;  // Generation equal to the current one.
+    if ((prev != nullptr) && !expired &&
+        ((prev->slot < 0) ||
+         log_master[prev->slot].cells.same_cells(petri_dish))) {
+        repeated = prev->gen;
+    } else if ((history == History::fingerprints) && (far.gen >= 0) &&
+               (far.fingerprint == fingerprint)) {
+        repeated = far.gen;  // A period longer than the window.
+    }
 
-        if (equal) {
-            std::cerr
-                << "\033[0;31m>>> Simulation ended due to stability. \033[0m\n";
-            std::cerr << "\033[0;31m>>> Generation [" << (i + 1)
-                      << "] equals to [" << num_gen + 1 << "]. \033[0m\n\n";
-            return true;
-        }
+    if (repeated >= 0) {
+        std::cerr
+            << "\033[0;31m>>> Simulation ended due to stability. \033[0m\n";
+        std::cerr << "\033[0;31m>>> Generation [" << (repeated + 1)
+                  << "] equals to [" << num_gen + 1 << "], period "
+                  << (num_gen - repeated) << ". \033[0m\n\n";
+        return true;
     }
 
+    remember(fingerprint, num_gen);
     return false;
-}
\ No newline at end of file
+}
@@ -0,0 +1,316 @@
+#include "../include/gen_log.h"
+
+#include <fcntl.h>     // open()
+#include <sys/mman.h>  // mmap(), munmap()
+#include <sys/stat.h>  // fstat()
+#include <unistd.h>    // close()
+
+#include <algorithm>  // std::copy, std::equal, std::upper_bound
+#include <cstring>    // std::memcpy
+#include <limits>     // std::numeric_limits
+
+#include "../include/pattern_file.h"
+
+namespace {
+
+//! Data handed over to the writer thread at once.
+const std::size_t buffer_bytes = 1 << 20;
+
+//! Keyframes indexed before the index grows: 2^20 generations at the
+//! default interval, 64 KiB.
+const std::size_t index_reserve = 1 << 12;
+
+}  // namespace
+
+GenLogWriter::GenLogWriter(const std::string &path, int keyframes)
+    : file(path, std::ios::binary | std::ios::trunc),
+      open((bool)file),
+      keyframes(keyframes) {
+    if (!open) {
+        return;
+    }
+
+    front.reserve(buffer_bytes * 2);
+    back.reserve(buffer_bytes * 2);
+    index.reserve(index_reserve);
+    thread = std::thread(&GenLogWriter::work, this);
+}
+
+GenLogWriter::~GenLogWriter() { close(); }
+
+void GenLogWriter::put(const void *data, std::size_t bytes) {
+    const char *first = (const char *)data;
+    front.insert(front.end(), first, first + bytes);
+    offset += bytes;
+}
+
+bool GenLogWriter::append(const Grid &cells, long long gen) {
+    if (!open) {
+        return false;
+    }
+
+    const std::size_t words = cells.row_words();
+    const std::uint64_t *mask = cells.interior_mask();
+
+    if (frames == 0) {
+        gen_log::LogHeader header = {};
+        std::copy(gen_log::magic, gen_log::magic + 8, header.magic);
+        header.version = gen_log::version;
+        header.rows = (std::uint32_t)cells.rows();
+        header.cols = (std::uint32_t)cells.cols();
+        header.keyframes = (std::uint32_t)keyframes;
+        put(&header, sizeof(header));
+
+        previous.assign((std::size_t)cells.rows() * words, 0);
+    }
+
+    gen_log::LogFrame frame = {};
+    frame.gen = (std::uint64_t)gen;
+    frame.key = (frames % keyframes) == 0;
+
+    if (frame.key) {
+        index.push_back({frame.gen, offset});
+    }
+
+    // Room for the worst case, one run per two words; the frame header is
+    // written once the runs are encoded.
+    const std::size_t at = front.size();
+    front.resize(at + sizeof(frame) + (previous.size() + 2) / 2 * 3 * 8);
+    std::uint64_t *const first = (std::uint64_t *)&front[at + sizeof(frame)];
+    std::uint64_t *out = first;
+    std::uint64_t *run = nullptr;  // Header of the open run of literals.
+    std::uint64_t zeros = 0;
+    std::size_t k = 0;
+
+    // One pass: visible cells only (the halo may hold the cells of a
+    // boundary), XOR the previous frame unless a keyframe, RLE.
+    for (int i = 1; i <= cells.rows(); i++) {
+        const std::uint64_t *row = cells.row(i);
+
+        for (std::size_t w = 0; w < words; w++, k++) {
+            const std::uint64_t cell_word = row[w] & mask[w];
+            const std::uint64_t word =
+                frame.key ? cell_word : (cell_word ^ previous[k]);
+            previous[k] = cell_word;
+
+            if (word == 0) {
+                if (run != nullptr) {
+                    *run = (zeros << 32) | (std::uint64_t)(out - run - 1);
+                    run = nullptr;
+                    zeros = 0;
+                }
+                zeros++;
+            } else {
+                if (run == nullptr) {
+                    run = out++;
+                }
+                *out++ = word;
+            }
+        }
+    }
+
+    // Trailing zeros are implied.
+    if (run != nullptr) {
+        *run = (zeros << 32) | (std::uint64_t)(out - run - 1);
+    }
+
+    frame.words = (std::uint32_t)(out - first);
+    std::memcpy(&front[at], &frame, sizeof(frame));
+    front.resize(at + sizeof(frame) + frame.words * 8);
+    offset += sizeof(frame) + frame.words * 8;
+
+    frames++;
+
+    if (front.size() >= buffer_bytes) {
+        flush();
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    return !failed;
+}
+
+void GenLogWriter::flush() {
+    std::unique_lock<std::mutex> guard(lock);
+    ready.wait(guard, [this] { return !has_back; });
+
+    front.swap(back);  // The front takes the storage already written.
+    front.clear();
+    has_back = true;
+    ready.notify_all();
+}
+
+bool GenLogWriter::close() {
+    if (!open) {
+        return false;
+    }
+
+    // Index of the keyframes, then the trailer that points to it.
+    gen_log::LogTrailer trailer = {};
+    trailer.index = offset;
+    trailer.entries = index.size();
+    std::copy(gen_log::magic, gen_log::magic + 8, trailer.magic);
+    put(index.data(), index.size() * sizeof(gen_log::LogIndexEntry));
+    put(&trailer, sizeof(trailer));
+    flush();
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stop = true;
+    }
+    ready.notify_all();
+    thread.join();
+
+    file.close();
+    open = false;
+
+    return !failed && !file.fail();
+}
+
+void GenLogWriter::work() {
+    std::unique_lock<std::mutex> guard(lock);
+
+    for (;;) {
+        ready.wait(guard, [this] { return has_back || stop; });
+
+        if (!has_back) {
+            return;  // Stopped, every buffer is written.
+        }
+
+        // The simulation keeps filling the front buffer meanwhile.
+        guard.unlock();
+        file.write(back.data(), back.size());
+        const bool ok = (bool)file;
+        guard.lock();
+
+        failed = failed || !ok;
+        has_back = false;
+        ready.notify_all();
+    }
+}
+
+GenLogReader::~GenLogReader() {
+    if (map != nullptr) {
+        munmap((void *)map, size);
+    }
+}
+
+bool GenLogReader::open(const std::string &path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if ((fstat(fd, &info) != 0) ||
+        ((std::size_t)info.st_size <
+         sizeof(gen_log::LogHeader) + sizeof(gen_log::LogTrailer))) {
+        ::close(fd);
+        return false;
+    }
+
+    size = (std::size_t)info.st_size;
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // The mapping stays valid.
+
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    map = (const char *)data;
+
+    // Header and trailer first, then an index that fits in between.
+    header = (const gen_log::LogHeader *)map;
+    const gen_log::LogTrailer *trailer =
+        (const gen_log::LogTrailer *)(map + size - sizeof(*trailer));
+
+    if (!std::equal(gen_log::magic, gen_log::magic + 8, header->magic) ||
+        !std::equal(gen_log::magic, gen_log::magic + 8, trailer->magic) ||
+        (header->version != gen_log::version) ||
+        (trailer->index < sizeof(gen_log::LogHeader)) ||
+        (trailer->index % 8 != 0) ||
+        (trailer->entries > (size - sizeof(*trailer) - trailer->index) /
+                                sizeof(gen_log::LogIndexEntry))) {
+        return false;
+    }
+
+    // The board must fit an int on each side, and in memory.
+    const std::uint32_t max_side = std::numeric_limits<int>::max();
+    if ((header->rows == 0) || (header->cols == 0) ||
+        (header->rows > max_side) || (header->cols > max_side) ||
+        ((std::uint64_t)header->rows * header->cols >
+         (std::uint64_t)PatternFile::max_cells)) {
+        return false;
+    }
+
+    index = (const gen_log::LogIndexEntry *)(map + trailer->index);
+    entries = (std::size_t)trailer->entries;
+    frames_end = (std::size_t)trailer->index;
+
+    return true;
+}
+
+bool GenLogReader::decode(const std::uint64_t *data, std::size_t words,
+                          Grid &cells, bool key) const {
+    const std::size_t row_words = cells.row_words();
+    const std::size_t total = (std::size_t)cells.rows() * row_words;
+
+    if (key) {
+        cells.clear();
+    }
+
+    std::size_t k = 0;  // Word of the visible cells, row after row.
+    for (std::size_t p = 0; p < words;) {
+        const std::uint64_t zeros = data[p] >> 32;
+        const std::size_t literals = (std::size_t)(data[p] & 0xffffffffu);
+
+        k += (std::size_t)zeros;
+        if ((literals > words - p - 1) || (k + literals > total)) {
+            return false;
+        }
+
+        for (std::size_t n = 1; n <= literals; n++, k++) {
+            cells.row((int)(k / row_words) + 1)[k % row_words] ^= data[p + n];
+        }
+        p += 1 + literals;
+    }
+
+    return true;
+}
+
+long long GenLogReader::seek(long long gen, Grid &cells) const {
+    // Last keyframe at or before gen.
+    const gen_log::LogIndexEntry *key = std::upper_bound(
+        index, index + entries, (std::uint64_t)gen,
+        [](std::uint64_t g, const gen_log::LogIndexEntry &entry) {
+            return g < entry.gen;
+        });
+
+    if ((gen < 0) || (key == index)) {
+        return -1;
+    }
+    --key;
+
+    // Then the frames that follow, up to gen.
+    std::size_t offset = (std::size_t)key->offset;
+    long long found = -1;
+    while (offset + sizeof(gen_log::LogFrame) <= frames_end) {
+        const gen_log::LogFrame *frame =
+            (const gen_log::LogFrame *)(map + offset);
+
+        if ((frame->gen > (std::uint64_t)gen) || ((found >= 0) && frame->key)) {
+            break;
+        }
+
+        const std::size_t bytes = (std::size_t)frame->words * 8;
+        offset += sizeof(*frame);
+        if ((bytes > frames_end - offset) ||
+            !decode((const std::uint64_t *)(map + offset), frame->words,
+                    cells, frame->key != 0)) {
+            return -1;
+        }
+
+        offset += bytes;
+        found = (long long)frame->gen;
+    }
+
+    return found;
+}
@@ -0,0 +1,157 @@
+#include "../include/grid.h"
+
+#include <cstdlib>  // posix_memalign(), free()
+#include <cstring>  // std::memcpy, std::memset
+#include <new>      // std::bad_alloc
+#include <utility>  // std::swap
+
+Grid::Grid() {}
+
+Grid::Grid(int nRows, int nCols) { resize(nRows, nCols); }
+
+Grid::Grid(const Grid &other)
+    : num_rows(other.num_rows),
+      num_cols(other.num_cols),
+      used_words(other.used_words),
+      stride(other.stride) {
+    if (other.buffer != nullptr) {
+        allocate();
+        std::memcpy(buffer, other.buffer, bytes());
+    }
+}
+
+Grid::Grid(Grid &&other) { swap(other); }
+
+Grid &Grid::operator=(const Grid &other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    if ((buffer == nullptr) || (num_rows != other.num_rows) ||
+        (num_cols != other.num_cols)) {
+        Grid copy(other);
+        swap(copy);
+    } else if (other.buffer != nullptr) {
+        std::memcpy(buffer, other.buffer, bytes());
+    }
+
+    return *this;
+}
+
+Grid &Grid::operator=(Grid &&other) {
+    swap(other);
+    return *this;
+}
+
+Grid::~Grid() { free(buffer); }
+
+void Grid::resize(int nRows, int nCols) {
+    free(buffer);
+    buffer = data = mask = nullptr;
+
+    num_rows = nRows;
+    num_cols = nCols;
+
+    // Columns 0..nCols+1, plus at least one zero word of padding, rounded up
+    // to whole cache lines.
+    used_words = ((std::size_t)nCols + 2 + 63) / 64;
+    stride = (used_words + 1 + line_words - 1) / line_words * line_words;
+
+    allocate();
+    std::memset(buffer, 0, bytes());
+
+    // Only the visible columns 1..nCols are set in the mask.
+    for (int j = 1; j <= nCols; j++) {
+        mask[j >> 6] |= std::uint64_t(1) << (j & 63);
+    }
+}
+
+void Grid::allocate() {
+    void *ptr = nullptr;
+    if (posix_memalign(&ptr, line_words * sizeof(std::uint64_t), bytes()) !=
+        0) {
+        throw std::bad_alloc();
+    }
+
+    // Layout: [mask][guard row][rows 0..nRows+1][guard row].
+    buffer = static_cast<std::uint64_t *>(ptr);
+    mask = buffer;
+    data = buffer + 2 * stride;
+}
+
+void Grid::clear() {
+    if (data != nullptr) {
+        std::memset(data - stride, 0,
+                    ((std::size_t)num_rows + 4) * stride *
+                        sizeof(std::uint64_t));
+    }
+}
+
+void Grid::fill_halo(Boundary boundary) {
+    if ((boundary == Boundary::dead) || (num_rows == 0) || (num_cols == 0)) {
+        return;
+    }
+
+    const bool torus = (boundary == Boundary::torus);
+
+    // Columns 0 and nCols + 1 of the visible rows.
+    const int left = torus ? num_cols : 1;
+    const int right = torus ? 1 : num_cols;
+    for (int i = 1; i <= num_rows; i++) {
+        set(i, 0, get(i, left));
+        set(i, num_cols + 1, get(i, right));
+    }
+
+    // Rows 0 and nRows + 1, the corners coming with the columns above.
+    std::memcpy(row(0), row(torus ? num_rows : 1),
+                used_words * sizeof(std::uint64_t));
+    std::memcpy(row(num_rows + 1), row(torus ? 1 : num_rows),
+                used_words * sizeof(std::uint64_t));
+}
+
+void Grid::swap(Grid &other) {
+    std::swap(buffer, other.buffer);
+    std::swap(data, other.data);
+    std::swap(mask, other.mask);
+    std::swap(num_rows, other.num_rows);
+    std::swap(num_cols, other.num_cols);
+    std::swap(used_words, other.used_words);
+    std::swap(stride, other.stride);
+}
+
+bool Grid::same_cells(const Grid &other) const {
+    if ((num_rows != other.num_rows) || (num_cols != other.num_cols)) {
+        return false;
+    }
+
+    for (int i = 1; i <= num_rows; i++) {
+        const std::uint64_t *a = row(i);
+        const std::uint64_t *b = other.row(i);
+
+        for (std::size_t w = 0; w < used_words; w++) {
+            if ((a[w] ^ b[w]) & mask[w]) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+long long Grid::population() const {
+    long long n = 0;
+
+    for (int i = 1; i <= num_rows; i++) {
+        const std::uint64_t *r = row(i);
+
+        for (std::size_t w = 0; w < used_words; w++) {
+            n += __builtin_popcountll(r[w] & mask[w]);
+        }
+    }
+
+    return n;
+}
+
+std::size_t Grid::bytes() const {
+    return ((std::size_t)num_rows + 5) * stride * sizeof(std::uint64_t);
+}
@@ -0,0 +1,456 @@
+#include "../include/hashlife.h"
+
+#include <algorithm>  // std::max, std::min
+
+namespace {
+
+//! Modulus of the hashes of the cells, the prime 2^61 - 1.
+const std::uint64_t prime = (std::uint64_t(1) << 61) - 1;
+
+//! Bases of the rows and of the columns, one pair per half.
+const std::uint64_t row_base[2] = {0x0c7b9e3df1a2655dULL,
+                                   0x19a5e3c8b1d02f47ULL};
+const std::uint64_t col_base[2] = {0x1f3d5b79a2c4e681ULL,
+                                   0x0e2b4d6f8a1c3e55ULL};
+
+inline std::uint64_t mul_mod(std::uint64_t a, std::uint64_t b) {
+    const unsigned __int128 product = (unsigned __int128)a * b;
+    const std::uint64_t x =
+        ((std::uint64_t)product & prime) + (std::uint64_t)(product >> 61);
+    return (x >= prime) ? x - prime : x;
+}
+
+inline std::uint64_t add_mod(std::uint64_t a, std::uint64_t b) {
+    const std::uint64_t x = a + b;
+    return (x >= prime) ? x - prime : x;
+}
+
+//! base^e, e of any sign (base^(prime - 1) = 1).
+std::uint64_t pow_mod(std::uint64_t base, std::int64_t e) {
+    const std::int64_t order = (std::int64_t)(prime - 1);
+    std::uint64_t n = (std::uint64_t)((e % order) + order) % (prime - 1);
+
+    std::uint64_t result = 1;
+    for (; n != 0; n >>= 1) {
+        if (n & 1) {
+            result = mul_mod(result, base);
+        }
+        base = mul_mod(base, base);
+    }
+
+    return result;
+}
+
+//! base^(2^level) of the bases, for every level a node can have.
+struct Shifts {
+    static const int levels = 128;
+    std::uint64_t row[2][levels], col[2][levels];
+
+    Shifts() {
+        for (int h = 0; h < 2; h++) {
+            row[h][0] = row_base[h];
+            col[h][0] = col_base[h];
+            for (int l = 1; l < levels; l++) {
+                row[h][l] = mul_mod(row[h][l - 1], row[h][l - 1]);
+                col[h][l] = mul_mod(col[h][l - 1], col[h][l - 1]);
+            }
+        }
+    }
+};
+
+const Shifts shifts;
+
+//! Whether the cells of the grid in the square (row, col, side) are dead.
+bool region_empty(const Grid &grid, std::int64_t row, std::int64_t col,
+                  std::int64_t side) {
+    using std::int64_t;
+    const int64_t top = std::max<int64_t>(row, 1);
+    const int64_t bottom = std::min<int64_t>(row + side, grid.rows() + 1);
+    const int64_t left = std::max<int64_t>(col, 1);
+    const int64_t right = std::min<int64_t>(col + side, grid.cols() + 1);
+
+    for (int64_t i = top; i < bottom; i++) {
+        const std::uint64_t *cells = grid.row((int)i);
+
+        for (int64_t j = left; j < right;) {
+            // Bits j..end - 1, without crossing the end of the word.
+            const int64_t end = std::min<int64_t>(right, (j | 63) + 1);
+            const std::uint64_t mask =
+                (end - j == 64) ? ~std::uint64_t(0)
+                                : (std::uint64_t(1) << (end - j)) - 1;
+
+            if (((cells[j >> 6] >> (j & 63)) & mask) != 0) {
+                return false;
+            }
+            j = end;
+        }
+    }
+
+    return true;
+}
+
+}  // namespace
+
+std::size_t HashLife::KeyHash::operator()(const Key &key) const {
+    const std::uint64_t a = ((std::uint64_t)key.nw << 32) | key.ne;
+    const std::uint64_t b = ((std::uint64_t)key.sw << 32) | key.se;
+    return (std::size_t)mix64(a ^ mix64(b));
+}
+
+HashLife::HashLife(const Rule &rule, std::size_t max_nodes)
+    : rule(rule), max_nodes(max_nodes) {
+    Grid nothing;
+    load(nothing);
+}
+
+void HashLife::load(const Grid &grid) {
+    pool.clear();
+    table.clear();
+    empties.clear();
+
+    // The two cells: 0 is dead and 1 is alive.
+    Node cell = {0, 0, 0, 0, 0, -1, 0, 0, Fingerprint()};
+    pool.push_back(cell);
+    cell.population = 1;
+    cell.cells.lo = cell.cells.hi = 1;  // x^0 y^0
+    pool.push_back(cell);
+    empties.push_back(0);
+
+    // Smallest square covering the board.
+    int level = 3;
+    while (((std::int64_t(1) << level) < grid.rows()) ||
+           ((std::int64_t(1) << level) < grid.cols())) {
+        level++;
+    }
+
+    root_row = root_col = 1;
+    root = build(grid, root_row, root_col, level);
+}
+
+HashLife::node_id HashLife::build(const Grid &grid, std::int64_t row,
+                                  std::int64_t col, int level) {
+    const std::int64_t side = std::int64_t(1) << level;
+
+    if (level == 0) {
+        const bool inside = (row >= 1) && (row <= grid.rows()) &&
+                            (col >= 1) && (col <= grid.cols());
+        return (inside && grid.get((int)row, (int)col) == 1) ? 1 : 0;
+    }
+
+    if (region_empty(grid, row, col, side)) {
+        return empty(level);
+    }
+
+    const std::int64_t half = side / 2;
+    const node_id nw = build(grid, row, col, level - 1);
+    const node_id ne = build(grid, row, col + half, level - 1);
+    const node_id sw = build(grid, row + half, col, level - 1);
+    const node_id se = build(grid, row + half, col + half, level - 1);
+
+    return join(nw, ne, sw, se);
+}
+
+HashLife::node_id HashLife::join(node_id nw, node_id ne, node_id sw,
+                                 node_id se) {
+    const Key key = {nw, ne, sw, se};
+
+    auto found = table.find(key);
+    if (found != table.end()) {
+        return found->second;
+    }
+
+    Node node;
+    node.nw = nw;
+    node.ne = ne;
+    node.sw = sw;
+    node.se = se;
+    node.result = 0;
+    node.result_k = -1;
+    node.level = pool[nw].level + 1;
+    node.population = pool[nw].population + pool[ne].population +
+                      pool[sw].population + pool[se].population;
+
+    // The quadrants moved to their place: x^half down, y^half right.
+    const int l = node.level - 1;
+    for (int h = 0; h < 2; h++) {
+        auto cells = [this, h](node_id id) {
+            return h ? pool[id].cells.hi : pool[id].cells.lo;
+        };
+        const std::uint64_t down = shifts.row[h][l], right = shifts.col[h][l];
+
+        (h ? node.cells.hi : node.cells.lo) = add_mod(
+            add_mod(cells(nw), mul_mod(right, cells(ne))),
+            mul_mod(down, add_mod(cells(sw), mul_mod(right, cells(se)))));
+    }
+
+    const node_id id = (node_id)pool.size();
+    pool.push_back(node);
+    table.emplace(key, id);
+
+    return id;
+}
+
+HashLife::node_id HashLife::empty(int level) {
+    while ((int)empties.size() <= level) {
+        const node_id e = empties.back();
+        empties.push_back(join(e, e, e, e));
+    }
+
+    return empties[level];
+}
+
+HashLife::node_id HashLife::base_step(const Node &node) {
+    // The 4x4 cells, bit (4 * row + col).
+    unsigned cells = 0;
+    const node_id quadrants[4] = {node.nw, node.ne, node.sw, node.se};
+    for (int q = 0; q < 4; q++) {
+        const Node &sub = pool[quadrants[q]];
+        const int row = (q / 2) * 2, col = (q % 2) * 2;
+
+        cells |= (unsigned)pool[sub.nw].population << (4 * row + col);
+        cells |= (unsigned)pool[sub.ne].population << (4 * row + col + 1);
+        cells |= (unsigned)pool[sub.sw].population << (4 * (row + 1) + col);
+        cells |= (unsigned)pool[sub.se].population
+                 << (4 * (row + 1) + col + 1);
+    }
+
+    // Next state from the table of the rule.
+    node_id next[4];
+    for (int k = 0; k < 4; k++) {
+        const int row = 1 + k / 2, col = 1 + k % 2;
+        int n = 0;  // Number of neighbors
+
+        for (int i = row - 1; i <= row + 1; i++) {
+            for (int j = col - 1; j <= col + 1; j++) {
+                if ((i != row) || (j != col)) {
+                    n += (cells >> (4 * i + j)) & 1;
+                }
+            }
+        }
+
+        const int cell = (cells >> (4 * row + col)) & 1;
+        next[k] = rule.next[cell][n];
+    }
+
+    return join(next[0], next[1], next[2], next[3]);
+}
+
+HashLife::node_id HashLife::successor(node_id id, int j) {
+    const Node node = pool[id];  // Copy, join() may move the pool.
+
+    if (node.population == 0) {
+        return empty(node.level - 1);
+    }
+
+    if (node.result_k == j) {
+        return node.result;
+    }
+
+    node_id result;
+    if (node.level == 2) {
+        result = base_step(node);
+    } else {
+        const Node a = pool[node.nw], b = pool[node.ne];
+        const Node c = pool[node.sw], d = pool[node.se];
+
+        // The 9 overlapping sub-squares of half the side.
+        node_id sub[3][3] = {
+            {node.nw, join(a.ne, b.nw, a.se, b.sw), node.ne},
+            {join(a.sw, a.se, c.nw, c.ne), join(a.se, b.sw, c.ne, d.nw),
+             join(b.sw, b.se, d.nw, d.ne)},
+            {node.sw, join(c.ne, d.nw, c.se, d.sw), node.se}};
+
+        if (j == node.level - 2) {
+            // Two half steps: centres of the 9, then of their 4 joins.
+            for (int r = 0; r < 3; r++) {
+                for (int s = 0; s < 3; s++) {
+                    sub[r][s] = successor(sub[r][s], j - 1);
+                }
+            }
+
+            node_id quad[4];
+            for (int q = 0; q < 4; q++) {
+                const int r = q / 2, s = q % 2;
+                quad[q] = successor(join(sub[r][s], sub[r][s + 1],
+                                         sub[r + 1][s], sub[r + 1][s + 1]),
+                                    j - 1);
+            }
+            result = join(quad[0], quad[1], quad[2], quad[3]);
+        } else {
+            // A single step of 2^j, then the centre of the 9 results.
+            Node ahead[3][3];
+            for (int r = 0; r < 3; r++) {
+                for (int s = 0; s < 3; s++) {
+                    ahead[r][s] = pool[successor(sub[r][s], j)];
+                }
+            }
+
+            node_id quad[4];
+            for (int q = 0; q < 4; q++) {
+                const int r = q / 2, s = q % 2;
+                quad[q] = join(ahead[r][s].se, ahead[r][s + 1].sw,
+                               ahead[r + 1][s].ne, ahead[r + 1][s + 1].nw);
+            }
+            result = join(quad[0], quad[1], quad[2], quad[3]);
+        }
+    }
+
+    pool[id].result = result;
+    pool[id].result_k = j;
+
+    return result;
+}
+
+void HashLife::expand() {
+    const Node node = pool[root];
+    const node_id e = empty(node.level - 1);
+
+    root = join(join(e, e, e, node.nw), join(e, e, node.ne, e),
+                join(e, node.sw, e, e), join(node.se, e, e, e));
+
+    root_row -= std::int64_t(1) << (node.level - 1);
+    root_col -= std::int64_t(1) << (node.level - 1);
+}
+
+bool HashLife::centred() const {
+    const Node &node = pool[root];
+    const Node &a = pool[node.nw], &b = pool[node.ne];
+    const Node &c = pool[node.sw], &d = pool[node.se];
+
+    // Every quadrant only has cells in its sub-sub-quadrant next to the
+    // centre.
+    return (a.population == pool[pool[a.se].se].population) &&
+           (b.population == pool[pool[b.sw].sw].population) &&
+           (c.population == pool[pool[c.ne].ne].population) &&
+           (d.population == pool[pool[d.nw].nw].population);
+}
+
+void HashLife::advance(int k) {
+    if (pool.size() > max_nodes) {
+        collect();
+    }
+
+    // The cells fit in the centre quarter of the root, with one more level
+    // of dead cells around, so that growing at c for 2^k generations they
+    // stay inside the centre half computed by successor().
+    while ((pool[root].level < std::max(3, k + 2)) || !centred()) {
+        expand();
+    }
+    expand();
+
+    const int level = pool[root].level;
+    root = successor(root, k);
+    root_row += std::int64_t(1) << (level - 2);
+    root_col += std::int64_t(1) << (level - 2);
+}
+
+long long HashLife::population() const { return pool[root].population; }
+
+Fingerprint HashLife::fingerprint() const {
+    const Fingerprint &cells = pool[root].cells;
+
+    // Moved from the top left of the root to the cell (0, 0) of the plane,
+    // and mixed for the tables keyed on the low bits.
+    Fingerprint fp;
+    fp.lo = mix64(mul_mod(cells.lo, mul_mod(pow_mod(row_base[0], root_row),
+                                            pow_mod(col_base[0], root_col))));
+    fp.hi = mix64(mul_mod(cells.hi, mul_mod(pow_mod(row_base[1], root_row),
+                                            pow_mod(col_base[1], root_col))));
+    return fp;
+}
+
+void HashLife::render(Grid &grid) const {
+    grid.clear();
+    paint(root, root_row, root_col, grid);
+}
+
+void HashLife::paint(node_id id, std::int64_t row, std::int64_t col,
+                     Grid &grid) const {
+    const Node &node = pool[id];
+    const std::int64_t side = std::int64_t(1) << node.level;
+
+    // Nothing alive, or outside the window.
+    if ((node.population == 0) || (row > grid.rows()) ||
+        (col > grid.cols()) || (row + side <= 1) || (col + side <= 1)) {
+        return;
+    }
+
+    if (node.level == 0) {
+        grid.set((int)row, (int)col, 1);
+        return;
+    }
+
+    const std::int64_t half = side / 2;
+    paint(node.nw, row, col, grid);
+    paint(node.ne, row, col + half, grid);
+    paint(node.sw, row + half, col, grid);
+    paint(node.se, row + half, col + half, grid);
+}
+
+void HashLife::collect() {
+    std::vector<char> marked(pool.size(), 0);
+    std::vector<node_id> stack(empties.begin(), empties.end());
+    stack.push_back(1);
+    stack.push_back(root);
+
+    // Mark the nodes reachable from the root and the empty nodes.
+    while (!stack.empty()) {
+        const node_id id = stack.back();
+        stack.pop_back();
+
+        if (marked[id]) {
+            continue;
+        }
+        marked[id] = 1;
+
+        const Node &node = pool[id];
+        if (node.level > 0) {
+            stack.push_back(node.nw);
+            stack.push_back(node.ne);
+            stack.push_back(node.sw);
+            stack.push_back(node.se);
+        }
+    }
+
+    // New ids keep the order, so the children still come first.
+    std::vector<node_id> remap(pool.size(), 0);
+    std::size_t kept = 0;
+    for (std::size_t id = 0; id < pool.size(); id++) {
+        if (marked[id]) {
+            remap[id] = (node_id)kept++;
+        }
+    }
+
+    table.clear();
+    for (std::size_t id = 0; id < pool.size(); id++) {
+        if (!marked[id]) {
+            continue;
+        }
+
+        Node node = pool[id];
+        if (node.level > 0) {
+            node.nw = remap[node.nw];
+            node.ne = remap[node.ne];
+            node.sw = remap[node.sw];
+            node.se = remap[node.se];
+
+            Key key = {node.nw, node.ne, node.sw, node.se};
+            table.emplace(key, remap[id]);
+        }
+
+        // Results whose nodes were dropped are computed again if needed.
+        if ((node.result_k >= 0) && marked[node.result]) {
+            node.result = remap[node.result];
+        } else {
+            node.result_k = -1;
+        }
+
+        pool[remap[id]] = node;
+    }
+    pool.resize(kept);
+
+    for (auto &e : empties) {
+        e = remap[e];
+    }
+    root = remap[root];
+}
@@ -0,0 +1,342 @@
+#include "../include/image_writer.h"
+
+#include <algorithm>  // std::min, std::copy
+#include <cctype>     // std::toupper
+#include <iomanip>    // std::setw, std::setfill
+#include <sstream>    // std::ostringstream
+
+namespace {
+
+//! Colors listed by print_help().
+const struct {
+    const char *name;
+    Color color;
+} colors[] = {
+    {"BLACK", {0, 0, 0}},
+    {"BLUE", {0, 0, 255}},
+    {"CRIMSON", {220, 20, 60}},
+    {"DARK_GREEN", {0, 100, 0}},
+    {"DEEP_SKY_BLUE", {0, 191, 255}},
+    {"DODGER_BLUE", {30, 144, 255}},
+    {"GREEN", {0, 255, 0}},
+    {"LIGHT_BLUE", {173, 216, 230}},
+    {"LIGHT_GREY", {211, 211, 211}},
+    {"LIGHT_YELLOW", {255, 255, 224}},
+    {"RED", {255, 0, 0}},
+    {"STEEL_BLUE", {70, 130, 180}},
+    {"WHITE", {255, 255, 255}},
+    {"YELLOW", {255, 255, 0}},
+};
+
+//! Largest stored deflate block.
+const std::size_t max_block = 65535;
+
+//! Largest IDAT chunk written; PNG allows up to 2^31 - 1 bytes.
+const std::size_t max_chunk = std::size_t(1) << 20;
+
+//! CRC-32 of the PNG chunks, one byte at a time.
+std::uint32_t crc_update(std::uint32_t crc, const std::uint8_t *data,
+                         std::size_t size) {
+    static const std::vector<std::uint32_t> table = [] {
+        std::vector<std::uint32_t> t(256);
+        for (std::uint32_t n = 0; n < 256; n++) {
+            std::uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? (0xedb88320u ^ (c >> 1)) : (c >> 1);
+            }
+            t[n] = c;
+        }
+        return t;
+    }();
+
+    for (std::size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+//! Big-endian 32-bit value, as PNG stores them.
+void put32(std::uint8_t *out, std::uint32_t value) {
+    out[0] = (std::uint8_t)(value >> 24);
+    out[1] = (std::uint8_t)(value >> 16);
+    out[2] = (std::uint8_t)(value >> 8);
+    out[3] = (std::uint8_t)value;
+}
+
+//! Write a whole PNG chunk.
+void write_chunk(std::ofstream &file, const char *type,
+                 const std::uint8_t *data, std::uint32_t size) {
+    std::uint8_t head[8];
+    put32(head, size);
+    std::copy(type, type + 4, head + 4);
+
+    std::uint8_t tail[4];
+    put32(tail, crc_update(crc_update(0xffffffffu, head + 4, 4), data, size) ^
+                    0xffffffffu);
+
+    file.write((const char *)head, 8);
+    file.write((const char *)data, size);
+    file.write((const char *)tail, 4);
+}
+
+/*!@brief Zlib stream of stored deflate blocks, written as the data of IDAT
+ *chunks of at most max_chunk bytes. Its size is known in advance.
+ */
+class StoredStream {
+   public:
+    StoredStream(std::ofstream &file, std::size_t raw_size)
+        : file(file), raw_left(raw_size) {
+        const std::size_t blocks = (raw_size + max_block - 1) / max_block;
+        stream_left = 2 + 5 * blocks + raw_size + 4;
+
+        const std::uint8_t head[2] = {
+            0x78,  // Deflate, 32K window.
+            0x01   // No preset dictionary, check bits.
+        };
+        put(head, 2);
+    }
+
+    //! Append uncompressed data.
+    void data(const std::uint8_t *bytes, std::size_t size) {
+        while (size > 0) {
+            if (block_left == 0) {
+                // Block header: final flag, LEN and NLEN little-endian.
+                block_left = std::min(raw_left, max_block);
+                const std::uint8_t head[5] = {
+                    (std::uint8_t)(block_left == raw_left),
+                    (std::uint8_t)block_left, (std::uint8_t)(block_left >> 8),
+                    (std::uint8_t)~block_left,
+                    (std::uint8_t)(~block_left >> 8)};
+                put(head, 5);
+            }
+
+            const std::size_t n = std::min(size, block_left);
+            adler(bytes, n);
+            put(bytes, n);
+            block_left -= n;
+            raw_left -= n;
+            bytes += n;
+            size -= n;
+        }
+    }
+
+    //! Write the Adler-32 of the data, which ends the last chunk.
+    void finish() {
+        std::uint8_t tail[4];
+        put32(tail, (b << 16) | a);
+        put(tail, 4);
+    }
+
+   private:
+    //! Append bytes of the stream, opening and closing the chunks.
+    void put(const std::uint8_t *bytes, std::size_t size) {
+        while (size > 0) {
+            if (chunk_left == 0) {
+                chunk_left = std::min(stream_left, max_chunk);
+
+                std::uint8_t head[8];
+                put32(head, (std::uint32_t)chunk_left);
+                std::copy("IDAT", "IDAT" + 4, head + 4);
+                file.write((const char *)head, 8);
+                crc = crc_update(0xffffffffu, head + 4, 4);
+            }
+
+            const std::size_t n = std::min(size, chunk_left);
+            crc = crc_update(crc, bytes, n);
+            file.write((const char *)bytes, n);
+            chunk_left -= n;
+            stream_left -= n;
+            bytes += n;
+            size -= n;
+
+            if (chunk_left == 0) {
+                std::uint8_t tail[4];
+                put32(tail, crc ^ 0xffffffffu);
+                file.write((const char *)tail, 4);
+            }
+        }
+    }
+
+    void adler(const std::uint8_t *bytes, std::size_t size) {
+        while (size > 0) {
+            // 5552 bytes cannot overflow 32 bits before the modulo.
+            const std::size_t n = std::min(size, (std::size_t)5552);
+            for (std::size_t i = 0; i < n; i++) {
+                a += bytes[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+            bytes += n;
+            size -= n;
+        }
+    }
+
+    std::ofstream &file;
+    std::size_t raw_left;          //!< Data still to come.
+    std::size_t block_left = 0;    //!< Data still to come in this block.
+    std::size_t stream_left;       //!< Bytes of the stream still to come.
+    std::size_t chunk_left = 0;    //!< Bytes still to come in this chunk.
+    std::uint32_t crc = 0xffffffffu;  //!< CRC of the chunk so far.
+    std::uint32_t a = 1, b = 0;       //!< Adler-32 of the data so far.
+};
+
+}  // namespace
+
+bool find_color(const std::string &name, Color &color) {
+    std::string upper = name;
+    for (char &c : upper) {
+        c = (char)std::toupper((unsigned char)c);
+    }
+
+    for (const auto &entry : colors) {
+        if (upper == entry.name) {
+            color = entry.color;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+ImageWriter::ImageWriter(const std::string &dir, Format format, int blocksize,
+                         Color alive, Color background)
+    : dir(dir),
+      format(format),
+      blocksize(blocksize),
+      alive(alive),
+      background(background) {
+    if (!this->dir.empty() && (this->dir.back() != '/')) {
+        this->dir += '/';
+    }
+
+    thread = std::thread(&ImageWriter::work, this);
+}
+
+ImageWriter::~ImageWriter() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stop = true;
+    }
+    ready.notify_all();
+    thread.join();
+}
+
+bool ImageWriter::submit(const Grid &cells, long long gen) {
+    std::unique_lock<std::mutex> guard(lock);
+    ready.wait(guard, [this] { return !has_queued || failed; });
+
+    if (failed) {
+        return false;
+    }
+
+    queued = cells;  // Reuses the storage of the previous image.
+    queued_gen = gen;
+    has_queued = true;
+    ready.notify_all();
+
+    return true;
+}
+
+void ImageWriter::work() {
+    for (;;) {
+        long long gen;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            ready.wait(guard, [this] { return has_queued || stop; });
+
+            if (!has_queued) {
+                return;  // Stopped, every image is written.
+            }
+
+            encoding.swap(queued);
+            gen = queued_gen;
+            has_queued = false;
+        }
+        ready.notify_all();
+
+        if (!encode(gen)) {
+            std::lock_guard<std::mutex> guard(lock);
+            failed = true;
+            has_queued = false;
+            ready.notify_all();
+            return;
+        }
+    }
+}
+
+void ImageWriter::fill_scanline(int i) {
+    // Byte 0 is the filter type of the PNG rows (none), the pixels follow.
+    std::uint8_t *pixel = scanline.data() + 1;
+    const std::uint64_t *row = encoding.row(i);
+
+    for (int j = 1; j <= encoding.cols(); j++) {
+        const Color &c = ((row[j / 64] >> (j % 64)) & 1) ? alive : background;
+
+        for (int k = 0; k < blocksize; k++) {
+            pixel[0] = c.r;
+            pixel[1] = c.g;
+            pixel[2] = c.b;
+            pixel += 3;
+        }
+    }
+}
+
+void ImageWriter::write_png_rows(std::ofstream &file) {
+    const std::size_t height = (std::size_t)encoding.rows() * blocksize;
+    StoredStream stream(file, height * scanline.size());
+
+    for (int i = 1; i <= encoding.rows(); i++) {
+        fill_scanline(i);
+        for (int k = 0; k < blocksize; k++) {
+            stream.data(scanline.data(), scanline.size());
+        }
+    }
+
+    stream.finish();
+}
+
+bool ImageWriter::encode(long long gen) {
+    const std::size_t width = (std::size_t)encoding.cols() * blocksize;
+    const std::size_t height = (std::size_t)encoding.rows() * blocksize;
+    scanline.resize(1 + 3 * width);
+    scanline[0] = 0;
+
+    std::ostringstream name;
+    name << dir << "gen" << std::setfill('0') << std::setw(6) << gen
+         << (format == Format::png ? ".png" : ".ppm");
+
+    std::ofstream file(name.str(), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    if (format == Format::ppm) {
+        file << "P6\n" << width << " " << height << "\n255\n";
+
+        for (int i = 1; i <= encoding.rows(); i++) {
+            fill_scanline(i);
+            for (int k = 0; k < blocksize; k++) {
+                file.write((const char *)scanline.data() + 1,
+                           scanline.size() - 1);
+            }
+        }
+    } else {
+        const std::uint8_t signature[8] = {0x89, 'P',  'N',  'G',
+                                           '\r', '\n', 0x1a, '\n'};
+        file.write((const char *)signature, 8);
+
+        // Width, height, 8 bits per channel, RGB, no interlace.
+        std::uint8_t header[13] = {};
+        put32(header, (std::uint32_t)width);
+        put32(header + 4, (std::uint32_t)height);
+        header[8] = 8;
+        header[9] = 2;
+        write_chunk(file, "IHDR", header, 13);
+
+        write_png_rows(file);
+        write_chunk(file, "IEND", nullptr, 0);
+    }
+
+    return (bool)file.flush();
+}
@@ -2,7 +2,7 @@
 
 int Simulation::read_options(int argc, char *argv[]) {
     // Valid options available to read.
-    const struct option tmp[9] = {
+    const struct option tmp[29] = {
         {"help", no_argument, 0, 'h'},
         {"imgdir", 1, 0, 'd'},
         {"maxgen", 1, 0, 'm'},
@@ -11,6 +11,26 @@ int Simulation::read_options(int argc, char *argv[]) {
         {"bkgcolor", 1, 0, 'b'},
         {"alivecolor", 1, 0, 'a'},
         {"outfile", 1, 0, 'o'},
+        {"kernel", 1, 0, 'k'},
+        {"threads", 1, 0, 't'},
+        {"history", 1, 0, 'l'},
+        {"engine", 1, 0, 'e'},
+        {"jump", 1, 0, 'j'},
+        {"boundary", 1, 0, 'w'},
+        {"headless", no_argument, 0, 'q'},
+        {"render-every", 1, 0, 'r'},
+        {"imgformat", 1, 0, 'g'},
+        {"replay", 1, 0, 'p'},
+        {"gen", 1, 0, 'n'},
+        {"checkpoint-every", 1, 0, 'c'},
+        {"checkpoint-file", 1, 0, 'C'},
+        {"resume", 1, 0, 'u'},
+        {"rule", 1, 0, 'R'},
+        {"stats", no_argument, 0, 'S'},
+        {"stats-file", 1, 0, 'F'},
+        {"workers", 1, 0, 'W'},
+        {"tblock", 1, 0, 'T'},
+        {"census", no_argument, 0, 'x'},
         {0, 0, 0, 0},
     };
 
@@ -21,19 +41,23 @@ int Simulation::read_options(int argc, char *argv[]) {
         return -1;
     }
 
+    // Short version of the options above.
+    const char *short_opts =
+        "hd:m:f:s:b:a:o:k:t:l:e:j:w:qr:g:p:n:c:C:u:R:SF:W:T:x";
+
     int opt;
     while (optind < argc) {
-        if ((opt = getopt_long(argc, argv, "hd:m:f:s:b:a:o:", tmp, NULL)) !=
-            -1) {
+        if ((opt = getopt_long(argc, argv, short_opts, tmp, NULL)) != -1) {
             switch (opt) {
                 case 'h': /* -h or --help */
                     print_help();
                     return -1;
                 case 'd': /* -d or --imgdir */
                     options.imgdir = optarg;
+                    options.images = true;
                     break;
                 case 'm': /* -m or --maxgen */
-                    options.maxgen = atoi(optarg);
+                    options.maxgen = atoll(optarg);
                     break;
                 case 'f': /* -f or --fps */
                     options.fps = atoi(optarg);
@@ -49,6 +73,67 @@ int Simulation::read_options(int argc, char *argv[]) {
                     break;
                 case 'o': /* -s or --outfile */
                     options.outfile = optarg;
+                    options.log = true;
+                    break;
+                case 'k': /* -k or --kernel */
+                    options.kernel = optarg;
+                    break;
+                case 't': /* -t or --threads */
+                    options.threads = atoi(optarg);
+                    break;
+                case 'l': /* -l or --history */
+                    options.history = optarg;
+                    break;
+                case 'e': /* -e or --engine */
+                    options.engine = optarg;
+                    break;
+                case 'j': /* -j or --jump */
+                    options.jump = atoi(optarg);
+                    break;
+                case 'w': /* -w or --boundary */
+                    options.boundary = optarg;
+                    break;
+                case 'q': /* -q or --headless */
+                    options.headless = true;
+                    break;
+                case 'r': /* -r or --render-every */
+                    options.render_every = atoll(optarg);
+                    break;
+                case 'g': /* -g or --imgformat */
+                    options.imgformat = optarg;
+                    break;
+                case 'p': /* -p or --replay */
+                    options.replay = optarg;
+                    break;
+                case 'n': /* -n or --gen */
+                    options.replay_gen = atoll(optarg);
+                    break;
+                case 'c': /* -c or --checkpoint-every */
+                    options.checkpoint_every = atoll(optarg);
+                    break;
+                case 'C': /* -C or --checkpoint-file */
+                    options.checkpoint = optarg;
+                    break;
+                case 'u': /* -u or --resume */
+                    options.resume = optarg;
+                    break;
+                case 'R': /* -R or --rule */
+                    options.rule = optarg;
+                    break;
+                case 'S': /* -S or --stats */
+                    options.stats = true;
+                    break;
+                case 'F': /* -F or --stats-file */
+                    options.stats_file = optarg;
+                    break;
+                case 'W': /* -W or --workers */
+                    options.workers = atoi(optarg);
+                    break;
+                case 'T': /* -T or --tblock */
+                    options.tblock = atoi(optarg);
+                    break;
+                case 'x': /* -x or --census */
+                    options.census = true;
                     break;
 
                 // No valid arguments provided.
@@ -62,7 +147,8 @@ int Simulation::read_options(int argc, char *argv[]) {
     }
 
     // Verify if the path to data file was entered correctly.
-    if (options.inputfile == "") {
+    if ((options.inputfile == "") && (options.replay == "") &&
+        (options.resume == "")) {
         std::cerr << "\n\033[0;31mMissing data file or the path was entered "
                      "before the options.\033[0m\n\n";
         print_help();
@@ -73,24 +159,35 @@ int Simulation::read_options(int argc, char *argv[]) {
 }
 
 void Simulation::read_file() {
-    std::ifstream file;
-    file.exceptions(std::ifstream::badbit);
+    PatternFile file;
 
     std::cout << ">>> Trying to open input file [" << options.inputfile
               << "]... ";
-    file.open(options.inputfile);  // Open the file in reading mode.
 
     // Verify if successfully opened the file.
-    if (!file) {
-        std::cerr << "\n\033[0;31m>>> Error: opening/reading file\033[0m\n";
+    if (!file.open(options.inputfile)) {
+        if (file.too_large()) {
+            std::cerr << "\n\033[0;31m>>> Error: pattern too large in ["
+                      << options.inputfile << "] (more than "
+                      << PatternFile::max_cells << " cells).\033[0m\n";
+        } else {
+            std::cerr
+                << "\n\033[0;31m>>> Error: opening/reading file\033[0m\n";
+        }
         exit(EXIT_FAILURE);
     }
 
     std::cout << "done!\n";
     std::cout << ">>> Processing data, please wait...\n";
 
-    file >> num_rows >> num_col;  // Store the dimensions of the petri_dish
-    file >> cell_char;  // Store the char who will represent a living cell.
+    num_rows = file.rows();  // Store the dimensions of the petri_dish
+    num_col = file.cols();
+    cell_char = file.cell_char();  // Character of a living cell.
+
+    // The rule of an RLE pattern, unless --rule is given.
+    if (options.rule == "") {
+        options.rule = file.rule();
+    }
 
     std::cout << ">>> Grid size: " << num_rows << " rows by " << num_col
               << " cols.\n";
@@ -98,22 +195,103 @@ void Simulation::read_file() {
               << "'\n";
 
     // Prepare the matrix where the cells are stored.
-    prepare_petri(num_rows, num_col);
-
-    int i = 0;
-    std::string line;
-    // Save just the living cells represented by 'cell_char'.
-    while ((std::getline(file, line)) && (i < getNumRows() + 2)) {
-        for (auto j = 0; j < (int)line.size() && (j < getNumCol() + 2); j++) {
-            if (line[j] == getCellChar()) {
-                petri_dish[i][j + 1] = alive;  // Alive cell
-            }
-        }
-
-        i++;
+    try {
+        prepare_petri(num_rows, num_col);
+    } catch (const std::bad_alloc &) {
+        std::cerr << "\n\033[0;31m>>> Error: not enough memory for a board "
+                     "of " << num_rows << " by " << num_col
+                  << " cells.\033[0m\n";
+        exit(EXIT_FAILURE);
     }
 
-    file.close();
+    // Save just the living cells, straight into the bits of the rows.
+    if (!file.read(petri_dish)) {
+        std::cerr << "\n\033[0;31m>>> Error: invalid cells in ["
+                  << options.inputfile << "].\033[0m\n";
+        exit(EXIT_FAILURE);
+    }
 
     std::cout << ">>> Finished reading input data file." << std::endl;
 }
+
+void Simulation::load_replay() {
+    GenLogReader reader;
+
+    if (!reader.open(options.replay)) {
+        std::cerr << "\n\033[0;31m>>> Error: [" << options.replay
+                  << "] is not a generation log.\033[0m\n";
+        exit(EXIT_FAILURE);
+    }
+
+    cell_char = '*';  // The log only keeps the cells.
+    try {
+        prepare_petri(reader.rows(), reader.cols());
+    } catch (const std::bad_alloc &) {
+        std::cerr << "\n\033[0;31m>>> Error: not enough memory for a board "
+                     "of " << reader.rows() << " by " << reader.cols()
+                  << " cells.\033[0m\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // The log numbers the generations from 0, the screen from 1.
+    const auto start = std::chrono::steady_clock::now();
+    const long long found = reader.seek(options.replay_gen - 1, petri_dish);
+    const auto end = std::chrono::steady_clock::now();
+
+    if (found < 0) {
+        std::cerr << "\n\033[0;31m>>> Error: generation ["
+                  << options.replay_gen << "] is not in ["
+                  << options.replay << "].\033[0m\n";
+        exit(EXIT_FAILURE);
+    }
+
+    num_gen = found;
+    std::cerr << ">>> Replay: generation [" << (found + 1) << "] of ["
+              << options.replay << "] restored in "
+              << std::chrono::duration_cast<std::chrono::microseconds>(
+                     end - start)
+                     .count()
+              << " us.\n";
+}
+
+void Simulation::load_resume() {
+    Snapshot snapshot;
+
+    if (!read_snapshot(options.resume, snapshot)) {
+        std::cerr << "\n\033[0;31m>>> Error: [" << options.resume
+                  << "] is not a valid checkpoint.\033[0m\n";
+        exit(EXIT_FAILURE);
+    }
+
+    cell_char = snapshot.cell_char;
+    prepare_petri(snapshot.cells.rows(), snapshot.cells.cols());
+    petri_dish = snapshot.cells;
+    num_gen = snapshot.gen;
+
+    // The run goes on as it was saved, whatever --rule and --boundary say.
+    const char *boundaries[] = {"dead", "torus", "mirror"};
+    options.rule = snapshot.rule.name();
+    options.boundary = boundaries[(int)snapshot.boundary];
+
+    // Only the fingerprints of the previous generations are kept, oldest
+    // first: a newer generation replaces an older one of the same
+    // fingerprint, and History::fingerprints fills its ring in order.
+    std::sort(snapshot.seen.begin(), snapshot.seen.end(),
+              [](const SnapshotEntry &a, const SnapshotEntry &b) {
+                  return a.gen < b.gen;
+              });
+    if (history != History::fingerprints) {
+        seen.reserve(snapshot.seen.size());
+    }
+    for (const SnapshotEntry &entry : snapshot.seen) {
+        remember(entry.fingerprint, entry.gen);
+    }
+    if (snapshot.far.gen >= 0) {
+        far = snapshot.far;
+        far_span = snapshot.far_span;
+    }
+
+    std::cerr << ">>> Resuming generation [" << (num_gen + 1) << "] from ["
+              << options.resume << "], rule " << options.rule << ", "
+              << options.boundary << " boundary.\n";
+}
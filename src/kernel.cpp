@@ -0,0 +1,73 @@
+#include "../include/kernel_impl.h"
+
+void life_span_scalar(const StepSpan &span) { life_span<ScalarOps>(span); }
+
+void any_rule_span_scalar(const StepSpan &span) {
+    any_rule_span<ScalarOps>(span);
+}
+
+step_kernel find_kernel(const std::string &name, bool any_rule) {
+    if (name == "auto") {
+        return find_kernel(auto_kernel_name(), any_rule);
+    }
+
+    if (name == "scalar") {
+        return any_rule ? any_rule_span_scalar : life_span_scalar;
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+
+    if ((name == "sse2") && __builtin_cpu_supports("sse2")) {
+        return any_rule ? any_rule_span_sse2 : life_span_sse2;
+    }
+
+    if ((name == "avx2") && __builtin_cpu_supports("avx2")) {
+        return any_rule ? any_rule_span_avx2 : life_span_avx2;
+    }
+
+    if ((name == "avx512") && __builtin_cpu_supports("avx512f")) {
+        return any_rule ? any_rule_span_avx512 : life_span_avx512;
+    }
+#endif
+
+    return nullptr;  // Unknown or unsupported.
+}
+
+std::string auto_kernel_name() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f")) {
+        return "avx512";
+    }
+
+    if (__builtin_cpu_supports("avx2")) {
+        return "avx2";
+    }
+
+    if (__builtin_cpu_supports("sse2")) {
+        return "sse2";
+    }
+#endif
+
+    return "scalar";
+}
+
+StepSpan full_span(const Grid &front, Grid &back) {
+    StepSpan span;
+    span.front = front.row(0);
+    span.back = back.row(0);
+    span.mask = front.interior_mask();
+    span.stride = front.row_stride();
+    span.row_begin = 1;
+    span.row_end = front.rows() + 1;
+    span.word_begin = 0;
+    span.word_end = front.row_words();
+
+    const Rule life;
+    span.birth = life.birth;
+    span.survive = life.survive;
+
+    return span;
+}
@@ -0,0 +1,37 @@
+// Built with -mavx2 (see the Makefile), only called after checking the CPU.
+#include "../include/kernel_impl.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>  // AVX2
+
+//! 256 cells per vector.
+struct Avx2Ops {
+    using vec = __m256i;
+    static const std::size_t lanes = 4;  //!< Words per vector.
+
+    static inline vec load(const std::uint64_t *p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    }
+    static inline void store(std::uint64_t *p, vec v) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v);
+    }
+    static inline vec bit_and(vec a, vec b) { return _mm256_and_si256(a, b); }
+    static inline vec bit_or(vec a, vec b) { return _mm256_or_si256(a, b); }
+    static inline vec bit_xor(vec a, vec b) { return _mm256_xor_si256(a, b); }
+    static inline vec and_not(vec a, vec b) {
+        return _mm256_andnot_si256(a, b);
+    }
+    static inline vec shl1(vec a) { return _mm256_slli_epi64(a, 1); }
+    static inline vec shr1(vec a) { return _mm256_srli_epi64(a, 1); }
+    static inline vec shl63(vec a) { return _mm256_slli_epi64(a, 63); }
+    static inline vec shr63(vec a) { return _mm256_srli_epi64(a, 63); }
+};
+
+void life_span_avx2(const StepSpan &span) { life_span<Avx2Ops>(span); }
+
+void any_rule_span_avx2(const StepSpan &span) {
+    any_rule_span<Avx2Ops>(span);
+}
+
+#endif
@@ -0,0 +1,37 @@
+// Built with -mavx512f (see the Makefile), only called after checking the CPU.
+#include "../include/kernel_impl.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>  // AVX-512F
+
+//! 512 cells per vector.
+struct Avx512Ops {
+    using vec = __m512i;
+    static const std::size_t lanes = 8;  //!< Words per vector.
+
+    static inline vec load(const std::uint64_t *p) {
+        return _mm512_loadu_si512(reinterpret_cast<const __m512i *>(p));
+    }
+    static inline void store(std::uint64_t *p, vec v) {
+        _mm512_storeu_si512(reinterpret_cast<__m512i *>(p), v);
+    }
+    static inline vec bit_and(vec a, vec b) { return _mm512_and_si512(a, b); }
+    static inline vec bit_or(vec a, vec b) { return _mm512_or_si512(a, b); }
+    static inline vec bit_xor(vec a, vec b) { return _mm512_xor_si512(a, b); }
+    static inline vec and_not(vec a, vec b) {
+        return _mm512_andnot_si512(a, b);
+    }
+    static inline vec shl1(vec a) { return _mm512_slli_epi64(a, 1); }
+    static inline vec shr1(vec a) { return _mm512_srli_epi64(a, 1); }
+    static inline vec shl63(vec a) { return _mm512_slli_epi64(a, 63); }
+    static inline vec shr63(vec a) { return _mm512_srli_epi64(a, 63); }
+};
+
+void life_span_avx512(const StepSpan &span) { life_span<Avx512Ops>(span); }
+
+void any_rule_span_avx512(const StepSpan &span) {
+    any_rule_span<Avx512Ops>(span);
+}
+
+#endif
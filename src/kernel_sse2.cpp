@@ -0,0 +1,35 @@
+// Built with -msse2 (see the Makefile), only called after checking the CPU.
+#include "../include/kernel_impl.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <emmintrin.h>  // SSE2
+
+//! 128 cells per vector.
+struct Sse2Ops {
+    using vec = __m128i;
+    static const std::size_t lanes = 2;  //!< Words per vector.
+
+    static inline vec load(const std::uint64_t *p) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    }
+    static inline void store(std::uint64_t *p, vec v) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v);
+    }
+    static inline vec bit_and(vec a, vec b) { return _mm_and_si128(a, b); }
+    static inline vec bit_or(vec a, vec b) { return _mm_or_si128(a, b); }
+    static inline vec bit_xor(vec a, vec b) { return _mm_xor_si128(a, b); }
+    static inline vec and_not(vec a, vec b) { return _mm_andnot_si128(a, b); }
+    static inline vec shl1(vec a) { return _mm_slli_epi64(a, 1); }
+    static inline vec shr1(vec a) { return _mm_srli_epi64(a, 1); }
+    static inline vec shl63(vec a) { return _mm_slli_epi64(a, 63); }
+    static inline vec shr63(vec a) { return _mm_srli_epi64(a, 63); }
+};
+
+void life_span_sse2(const StepSpan &span) { life_span<Sse2Ops>(span); }
+
+void any_rule_span_sse2(const StepSpan &span) {
+    any_rule_span<Sse2Ops>(span);
+}
+
+#endif
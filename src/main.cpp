@@ -20,8 +20,9 @@ int main(int argc, char* argv[]) {
         game.process_events();  // Verificar REGRAS.
         game.update();          // Atualizar o board.
         game.render();          // Exibir o board
-        usleep(1000000);
     }
 
+    game.finish();  // Headless: show the last generation.
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,409 @@
+#include "../include/pattern_file.h"
+
+#include <fcntl.h>     // open()
+#include <sys/mman.h>  // mmap(), munmap(), madvise()
+#include <sys/stat.h>  // fstat()
+#include <unistd.h>    // close()
+
+#include <algorithm>  // std::min, std::max
+#include <cctype>     // std::isalpha
+#include <cstdint>    // std::uint64_t
+#include <cstring>    // std::memchr, std::memcpy, std::strncmp
+#include <limits>     // std::numeric_limits
+
+const long long PatternFile::max_cells;
+
+namespace {
+
+//! Largest board side accepted.
+const long long max_side = std::numeric_limits<int>::max() / 2;
+
+inline bool is_blank(char c) {
+    return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n');
+}
+
+//! Skip spaces and tabs, and line breaks too if `lines`.
+void skip_blanks(const char *&p, const char *end, bool lines) {
+    while ((p < end) && is_blank(*p) && (lines || (*p != '\n'))) {
+        p++;
+    }
+}
+
+//! Skip the rest of the line, line break included.
+void skip_line(const char *&p, const char *end) {
+    const char *nl = (const char *)std::memchr(p, '\n', end - p);
+    p = nl ? nl + 1 : end;
+}
+
+//! Read an integer, after spaces (and line breaks if `lines`).
+bool parse_int(const char *&p, const char *end, long long &value,
+               bool lines = true) {
+    skip_blanks(p, end, lines);
+
+    bool negative = false;
+    if ((p < end) && ((*p == '-') || (*p == '+'))) {
+        negative = *p++ == '-';
+    }
+
+    if ((p == end) || (*p < '0') || (*p > '9')) {
+        return false;
+    }
+
+    value = 0;
+    while ((p < end) && (*p >= '0') && (*p <= '9')) {
+        if (value > max_side) {
+            return false;
+        }
+        value = value * 10 + (*p++ - '0');
+    }
+
+    if (negative) {
+        value = -value;
+    }
+    return true;
+}
+
+//! Set the cells j0..j1 - 1 of row i.
+void set_run(Grid &cells, int i, long long j0, long long j1) {
+    std::uint64_t *row = cells.row(i);
+
+    while (j0 < j1) {
+        const int shift = (int)(j0 & 63);
+        const long long n = std::min<long long>(64 - shift, j1 - j0);
+        const std::uint64_t bits =
+            (n == 64) ? ~std::uint64_t(0) : ((std::uint64_t(1) << n) - 1);
+        row[j0 >> 6] |= bits << shift;
+        j0 += n;
+    }
+}
+
+/*!@brief Bits of the bytes equal to c among 8 (SWAR compare).
+ *@return Bit k set if byte k of `bytes` is c.
+ */
+inline unsigned match8(std::uint64_t bytes, std::uint64_t c) {
+    const std::uint64_t low = 0x7f7f7f7f7f7f7f7full;
+    const std::uint64_t x = bytes ^ c;
+
+    // High bit of a byte set if the byte is not zero, without carries.
+    const std::uint64_t nonzero = ((x & low) + low) | x;
+    const std::uint64_t equal = ~nonzero & ~low;
+
+    // Gather the high bits of the bytes into bits 0 to 7.
+    return (unsigned)(((equal >> 7) * 0x0102040810204080ull) >> 56);
+}
+
+}  // namespace
+
+PatternFile::~PatternFile() {
+    if (map != nullptr) {
+        munmap((void *)map, size);
+    }
+}
+
+bool PatternFile::open(const std::string &path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if ((fstat(fd, &info) != 0) || (info.st_size == 0)) {
+        ::close(fd);
+        return false;
+    }
+
+    size = (std::size_t)info.st_size;
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // The mapping stays valid.
+
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    map = (const char *)data;
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    // Life 1.06 has a header line, RLE has "x = " after its comments.
+    if ((size >= 10) && (std::strncmp(map, "#Life 1.06", 10) == 0)) {
+        fmt = Format::life106;
+        return open_life106();
+    }
+
+    const char *p = map;
+    const char *end = map + size;
+    while (p < end) {
+        skip_blanks(p, end, true);
+        if ((p < end) && (*p == '#')) {
+            skip_line(p, end);
+        } else {
+            break;
+        }
+    }
+
+    if ((p < end) && (*p == 'x')) {
+        fmt = Format::rle;
+        return open_rle();
+    }
+
+    fmt = Format::dat;
+    return open_dat();
+}
+
+bool PatternFile::set_size(long long nRows, long long nCols) {
+    // Sides of at most max_side cannot overflow the product.
+    if ((nRows > max_side) || (nCols > max_side) ||
+        (nRows * nCols > max_cells)) {
+        oversized = true;
+        return false;
+    }
+
+    num_rows = (int)nRows;
+    num_cols = (int)nCols;
+    return true;
+}
+
+bool PatternFile::read(Grid &cells) const {
+    switch (fmt) {
+        case Format::rle:
+            return read_rle(cells);
+        case Format::life106:
+            return read_life106(cells);
+        default:
+            return read_dat(cells);
+    }
+}
+
+bool PatternFile::open_dat() {
+    const char *p = map;
+    const char *end = map + size;
+    long long r, c;
+
+    if (!parse_int(p, end, r) || !parse_int(p, end, c) || (r < 1) ||
+        (c < 1)) {
+        return false;
+    }
+
+    skip_blanks(p, end, true);
+    if (p == end) {
+        return false;
+    }
+    alive = *p++;
+
+    // The rest of the line of the character is not part of the board.
+    skip_line(p, end);
+
+    body = (std::size_t)(p - map);
+    return set_size(r, c);
+}
+
+bool PatternFile::read_dat(Grid &cells) const {
+    const char *p = map + body;
+    const char *end = map + size;
+    const std::uint64_t c = 0x0101010101010101ull * (unsigned char)alive;
+
+    // Line n of the board is row n + 1 and its character k is column k + 1,
+    // the halo row and column 0 stay dead.
+    for (int i = 1; (i <= num_rows) && (p < end); i++) {
+        const char *nl = (const char *)std::memchr(p, '\n', end - p);
+        const char *line_end = nl ? nl : end;
+        const long long len = std::min<long long>(line_end - p, num_cols);
+        std::uint64_t *row = cells.row(i);
+
+        // 8 characters at a time, into the bits of columns k + 1..k + 8.
+        long long k = 0;
+        for (; k + 8 <= len; k += 8) {
+            std::uint64_t bytes;
+            std::memcpy(&bytes, p + k, 8);
+            const std::uint64_t bits = match8(bytes, c);
+            if (bits == 0) {
+                continue;
+            }
+
+            const int shift = (int)((k + 1) & 63);
+            row[(k + 1) >> 6] |= bits << shift;
+            if (shift > 56) {
+                row[((k + 1) >> 6) + 1] |= bits >> (64 - shift);
+            }
+        }
+
+        for (; k < len; k++) {
+            if (p[k] == alive) {
+                cells.set(i, (int)k + 1, 1);
+            }
+        }
+
+        p = nl ? nl + 1 : end;
+    }
+
+    return true;
+}
+
+bool PatternFile::open_rle() {
+    const char *p = map;
+    const char *end = map + size;
+
+    // Comments, then "x = m, y = n[, rule = ...]".
+    for (;;) {
+        skip_blanks(p, end, true);
+        if ((p < end) && (*p == '#')) {
+            skip_line(p, end);
+        } else {
+            break;
+        }
+    }
+
+    long long x, y;
+    p++;  // 'x'
+    skip_blanks(p, end, false);
+    if ((p == end) || (*p++ != '=') || !parse_int(p, end, x, false)) {
+        return false;
+    }
+
+    skip_blanks(p, end, false);
+    if ((p < end) && (*p == ',')) {
+        p++;
+    }
+    skip_blanks(p, end, false);
+    if ((p == end) || (*p++ != 'y')) {
+        return false;
+    }
+    skip_blanks(p, end, false);
+    if ((p == end) || (*p++ != '=') || !parse_int(p, end, y, false) ||
+        (x < 0) || (y < 0)) {
+        return false;
+    }
+
+    // Optional ", rule = B3/S23".
+    skip_blanks(p, end, false);
+    if ((p < end) && (*p == ',')) {
+        p++;
+        skip_blanks(p, end, false);
+
+        const char *key = p;
+        while ((p < end) && std::isalpha((unsigned char)*p)) {
+            p++;
+        }
+        skip_blanks(p, end, false);
+
+        if ((std::string(key, p - key) == "rule") &&
+            (p < end) && (*p == '=')) {
+            p++;
+            skip_blanks(p, end, false);
+
+            const char *value = p;
+            while ((p < end) && !is_blank(*p)) {
+                p++;
+            }
+            rule_name.assign(value, p - value);
+        }
+    }
+
+    skip_line(p, end);
+
+    body = (std::size_t)(p - map);
+    return set_size(y + 2 * margin, x + 2 * margin);
+}
+
+bool PatternFile::read_rle(Grid &cells) const {
+    const char *p = map + body;
+    const char *end = map + size;
+    const long long width = num_cols - 2 * margin;
+    const long long height = num_rows - 2 * margin;
+    long long i = 0, j = 0;  // Cell of the pattern.
+
+    while (p < end) {
+        long long count = 1;
+        if ((*p >= '0') && (*p <= '9')) {
+            if (!parse_int(p, end, count, false) || (p == end)) {
+                return false;
+            }
+        }
+
+        const char tag = *p++;
+        if (is_blank(tag)) {
+            continue;
+        } else if (tag == '!') {
+            break;
+        } else if (tag == '$') {
+            i += count;
+            j = 0;
+        } else if ((tag == 'b') || (tag == '.')) {
+            j += count;
+        } else if (std::isalpha((unsigned char)tag)) {
+            // 'o', or any state of a multistate pattern.
+            if ((i >= height) || (j + count > width)) {
+                return false;
+            }
+            set_run(cells, (int)i + margin + 1, j + margin + 1,
+                    j + count + margin + 1);
+            j += count;
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool PatternFile::open_life106() {
+    const char *p = map;
+    const char *end = map + size;
+    long long x, y;
+    long long max_x = 0, max_y = 0;
+    bool empty = true;
+
+    skip_line(p, end);  // "#Life 1.06"
+    body = (std::size_t)(p - map);
+
+    // Bounding box of the cells.
+    while (p < end) {
+        skip_blanks(p, end, true);
+        if (p == end) {
+            break;
+        } else if (*p == '#') {
+            skip_line(p, end);
+            continue;
+        }
+
+        if (!parse_int(p, end, x, false) || !parse_int(p, end, y, false)) {
+            return false;
+        }
+
+        if (empty) {
+            min_x = max_x = x;
+            min_y = max_y = y;
+            empty = false;
+        } else {
+            min_x = std::min(min_x, x);
+            max_x = std::max(max_x, x);
+            min_y = std::min(min_y, y);
+            max_y = std::max(max_y, y);
+        }
+    }
+
+    return set_size((empty ? 0 : max_y - min_y + 1) + 2 * margin,
+                    (empty ? 0 : max_x - min_x + 1) + 2 * margin);
+}
+
+bool PatternFile::read_life106(Grid &cells) const {
+    const char *p = map + body;
+    const char *end = map + size;
+    long long x, y;
+
+    while (p < end) {
+        skip_blanks(p, end, true);
+        if (p == end) {
+            break;
+        } else if (*p == '#') {
+            skip_line(p, end);
+            continue;
+        }
+
+        if (!parse_int(p, end, x, false) || !parse_int(p, end, y, false)) {
+            return false;
+        }
+        cells.set((int)(y - min_y) + margin + 1, (int)(x - min_x) + margin + 1,
+                  1);
+    }
+
+    return true;
+}
@@ -10,6 +10,27 @@ void Simulation::print_options() {
     std::cout << "alivecolor: " << options.alivecolor << std::endl;
     std::cout << "inputfile: \"" << options.inputfile << "\"" << std::endl;
     std::cout << "outfile: '\"" << options.outfile << "\"" << std::endl;
+    std::cout << "kernel: " << options.kernel << std::endl;
+    std::cout << "threads: " << options.threads << std::endl;
+    std::cout << "history: " << options.history << std::endl;
+    std::cout << "engine: " << options.engine << std::endl;
+    std::cout << "jump: " << options.jump << std::endl;
+    std::cout << "boundary: " << options.boundary << std::endl;
+    std::cout << "headless: " << options.headless << std::endl;
+    std::cout << "render-every: " << options.render_every << std::endl;
+    std::cout << "imgformat: " << options.imgformat << std::endl;
+    std::cout << "replay: \"" << options.replay << "\"" << std::endl;
+    std::cout << "gen: " << options.replay_gen << std::endl;
+    std::cout << "checkpoint-every: " << options.checkpoint_every << std::endl;
+    std::cout << "checkpoint-file: \"" << options.checkpoint << "\""
+              << std::endl;
+    std::cout << "resume: \"" << options.resume << "\"" << std::endl;
+    std::cout << "rule: " << options.rule << std::endl;
+    std::cout << "stats: " << options.stats << std::endl;
+    std::cout << "stats-file: \"" << options.stats_file << "\"" << std::endl;
+    std::cout << "workers: " << options.workers << std::endl;
+    std::cout << "tblock: " << options.tblock << std::endl;
+    std::cout << "census: " << options.census << std::endl;
 }
 
 void Simulation::print_matrix() {
@@ -24,7 +45,7 @@ void Simulation::print_matrix() {
         }
 
         for (int j = 0; j < num_col; j++) {
-            data << std::setw(1) << petri_dish[i][j] << " ";
+            data << std::setw(1) << petri_dish.get(i, j) << " ";
         }
         data << '\n';
     }
@@ -37,9 +58,12 @@ void Simulation::print_log() {
 
     data << "\nGeneration [" << (num_gen + 1) << "]:\n" << std::endl;
 
-    for (int j = 0; j < (int)log_master[num_gen].size(); j++) {
-        data << "[" << log_master[num_gen][j].x << ","
-             << log_master[num_gen][j].y << "] ";
+    for (int i = 1; i <= getNumRows(); i++) {
+        for (int j = 1; j <= getNumCol(); j++) {
+            if (petri_dish.get(i, j) == alive) {
+                data << "[" << i << "," << j << "] ";
+            }
+        }
     }
     data << std::endl;
 
@@ -47,25 +71,87 @@ void Simulation::print_log() {
 }
 
 void Simulation::print_petri() {
-    std::ostringstream data;
+    // Appended in place: the frame keeps its storage.
+    const auto border = [this]() {
+        frame += "\033[1;37m";
+        frame.append((std::size_t)getNumCol() + 4, '-');
+        frame += "\033[0m\n";
+    };
 
-    data << "\033[1;37m" << std::setfill('-') << std::setw(getNumCol() + 8)
-         << "\033[0m" << std::endl;
+    border();
     for (int i = 1; i < getNumRows() + 1; i++) {
-        data << "\033[1;37m| \033[0m";
+        frame += "\033[1;37m| \033[0m";
         for (int j = 1; j < getNumCol() + 1; j++) {
-            if (petri_dish[i][j] == dead) {
-                data << " ";
+            if (petri_dish.get(i, j) == dead) {
+                frame += ' ';
             } else {
-                data << std::setw(1) << "\033[1;32m" << cell_char << "\033[0m";
+                frame += "\033[1;32m";
+                frame += cell_char;
+                frame += "\033[0m";
             }
         }
-        data << " \033[1;37m|\033[0m\n";
+        frame += " \033[1;37m|\033[0m\n";
+    }
+    border();
+}
+
+void Simulation::print_generation() {
+    // Index of the current generation (keeps the storage of the previous
+    // titles).
+    title.clear();
+    title += "Generation [";
+    title += std::to_string(num_gen + 1);
+    title += "]:[";
+    if (options.maxgen == int_size) {
+        title += "\u221E]";
+    } else {
+        title += std::to_string(options.maxgen);
+        title += "]";
+    }
+
+    last_rendered = num_gen;
+    std::cout.flush();  // Keep the order of the messages already written.
+
+    // On a terminal, only the cells that changed are redrawn.
+    if (terminal) {
+        terminal->draw(petri_dish, cell_char, title);
+        return;
     }
-    data << "\033[1;37m" << std::setfill('-') << std::setw(getNumCol() + 8)
-         << "\033[0m" << std::endl;
 
-    std::cout << data.str();
+    frame.clear();  // Keeps the storage of the previous frames.
+    frame += title;
+    frame += '\n';
+    print_petri();  // Show the petri_dish.
+    frame += '\n';
+
+    write_all(STDOUT_FILENO, frame.data(), frame.size());
+}
+
+void Simulation::print_census() {
+    census->take(petri_dish, pool.get());
+
+    std::cerr << ">>> Census of generation [" << (num_gen + 1) << "]: "
+              << census->total() << " object(s), " << census->objects().size()
+              << " different.\n";
+    if (census->objects().empty()) {
+        return;
+    }
+
+    std::cerr << "    " << std::setw(8) << "count"
+              << "  " << std::left << std::setw(12) << "kind" << std::right
+              << std::setw(6) << "period" << std::setw(7) << "cells"
+              << "  name\n";
+    for (const CensusEntry &entry : census->objects()) {
+        std::cerr << "    " << std::setw(8) << entry.count << "  " << std::left
+                  << std::setw(12) << kind_name(entry.kind) << std::right
+                  << std::setw(6) << entry.period << std::setw(7)
+                  << entry.cells << "  " << entry.name;
+        if (entry.kind == ObjectKind::spaceship) {
+            std::cerr << " (moves " << entry.dx << ", " << entry.dy << ")";
+        }
+        std::cerr << "\n";
+    }
+    std::cerr << "\n";
 }
 
 void Simulation::print_help() {
@@ -75,18 +161,67 @@ void Simulation::print_help() {
            "\t--help\t\t\tPrint this help text.\n"
            "\t--imgdir <path>\t\tSpecify directory where output images are "
            "written to.\n"
+           "\t\t\t\tAn image per generation is written when given.\n"
+           "\t--imgformat <name>\tFile format of the images: png or ppm.\n"
+           "\t\t\t\tDefault png.\n"
            "\t--maxgen <num>\t\tMaximum number of generations to simulate.\n"
-           "\t--fps <num>\t\tNumber of generations presented per second.\n"
-           "\t--blocksize <num>\tPixel size of a cell. Default = 5.\n"
+           "\t--fps <num>\t\tNumber of generations presented per second, "
+           "0 to\n"
+           "\t\t\t\trun headless. Default 2.\n"
+           "\t--blocksize <num>\tPixel size of a cell. Default = 10.\n"
            "\t--bkgcolor <color>\tColor name for the background. Default "
            "GREEN.\n"
            "\t--alivecolor <color>\tColor name for representing alive cells. "
            "Default "
            "RED.\n"
-           "\t--outfile <filename>\tWrite the text representation of the "
-           "simulation to "
-           "the "
-           "given filename.\n\n"
+           "\t--outfile <filename>\tRecord the generations in the given "
+           "filename\n"
+           "\t\t\t\t(binary log, keyframes and XOR deltas).\n"
+           "\t--kernel <name>\t\tStep kernel: auto, avx512, avx2, sse2, "
+           "scalar or\n"
+           "\t\t\t\treference. Default auto.\n"
+           "\t--threads <num>\t\tNumber of threads stepping the generations. "
+           "Default 1.\n"
+           "\t--history <policy>\tWhat is kept to detect stability: none,\n"
+           "\t\t\t\tfingerprints (of the last 4096 generations, longer\n"
+           "\t\t\t\tperiods are found later), last-<num> (cells of the\n"
+           "\t\t\t\tlast <num> generations) or full. Default\n"
+           "\t\t\t\tfingerprints.\n"
+           "\t--engine <name>\t\tgrid (bounded board), sparse or hashlife\n"
+           "\t\t\t\t(unbounded plane, the board is a window). Default\n"
+           "\t\t\t\tgrid.\n"
+           "\t--jump <num>\t\tHashLife steps 2^<num> generations at once.\n"
+           "\t\t\t\tDefault 0.\n"
+           "\t--boundary <name>\tBeyond the edges of the grid engine: dead,\n"
+           "\t\t\t\ttorus (wrap around) or mirror. Default dead.\n"
+           "\t--headless\t\tStep as fast as possible and only show the last\n"
+           "\t\t\t\tgeneration.\n"
+           "\t--render-every <num>\tHeadless: also show every <num> "
+           "generations.\n"
+           "\t--replay <filename>\tShow a generation of a log recorded with\n"
+           "\t\t\t\t--outfile instead of running a simulation.\n"
+           "\t--gen <num>\t\tGeneration shown by --replay. Default 1.\n"
+           "\t--checkpoint-every <num> Save the state every <num> "
+           "generations.\n"
+           "\t--checkpoint-file <filename> Where the state is saved. Default\n"
+           "\t\t\t\tdata/checkpoint.bin.\n"
+           "\t--resume <filename>\tContinue from a saved state instead of a\n"
+           "\t\t\t\tdata file.\n"
+           "\t--rule <rule>\t\tLife-like rule in B/S notation, as B36/S23.\n"
+           "\t\t\t\tDefault B3/S23, or the rule of an RLE file.\n"
+           "\t--stats\t\t\tEvery second, show the generations per second,\n"
+           "\t\t\t\tpopulation, active tiles and time of each phase\n"
+           "\t\t\t\ton stderr.\n"
+           "\t--stats-file <filename> Rewrite the same stats in the given\n"
+           "\t\t\t\tfilename every second (Prometheus text format).\n"
+           "\t--workers <num>\t\tSplit the board in bands of rows, each one\n"
+           "\t\t\t\tstepped by a worker process (grid engine, dead\n"
+           "\t\t\t\tboundary). Default 1, no worker.\n"
+           "\t--tblock <num>\t\tHeadless: step tiles of the board <num>\n"
+           "\t\t\t\tgenerations at a time in the cache (up to 64,\n"
+           "\t\t\t\tgrid engine, dead boundary). Default 1.\n"
+           "\t--census\t\tAt the end, count the still lifes, oscillators\n"
+           "\t\t\t\tand spaceships of the last generation.\n\n"
            "Available colors are:\n"
            "\tBLACK BLUE CRIMSON DARK_GREEN DEEP_SKY_BLUE DODGER_BLUE\n"
            "\tGREEN LIGHT_BLUE LIGHT_GREY LIGHT_YELLOW RED STEEL_BLUE\n"
@@ -0,0 +1,78 @@
+#include "../include/rule.h"
+
+#include <cctype>  // std::toupper
+
+void Rule::compile() {
+    for (int n = 0; n <= 8; n++) {
+        next[0][n] = (birth >> n) & 1;
+        next[1][n] = (survive >> n) & 1;
+    }
+}
+
+bool Rule::is_life() const {
+    const Rule life;
+    return (birth == life.birth) && (survive == life.survive);
+}
+
+std::string Rule::name() const {
+    std::string text = "B";
+    for (int n = 0; n <= 8; n++) {
+        if ((birth >> n) & 1) {
+            text += (char)('0' + n);
+        }
+    }
+
+    text += "/S";
+    for (int n = 0; n <= 8; n++) {
+        if ((survive >> n) & 1) {
+            text += (char)('0' + n);
+        }
+    }
+
+    return text;
+}
+
+bool parse_rule(const std::string &text, Rule &rule) {
+    std::uint16_t masks[2] = {0, 0};  // Birth, survival.
+    int part = -1;                    // Mask the digits go to.
+    bool letters = false;             // B/S notation.
+    int slashes = 0;
+
+    for (char c : text) {
+        c = (char)std::toupper((unsigned char)c);
+
+        if ((c == 'B') || (c == 'S')) {
+            part = (c == 'B') ? 0 : 1;
+            letters = true;
+        } else if (c == '/') {
+            // S/B notation: survival first.
+            if (++slashes > 1) {
+                return false;
+            }
+            part = letters ? -1 : 0;
+        } else if ((c >= '0') && (c <= '8')) {
+            if (!letters && (slashes == 0)) {
+                part = 1;
+            }
+            if (part < 0) {
+                return false;
+            }
+            masks[part] |= (std::uint16_t)(1 << (c - '0'));
+        } else {
+            return false;
+        }
+    }
+
+    // "3/23" has a slash, "B3/S23" has both letters.
+    if (letters ? (text.find_first_of("Bb") == std::string::npos ||
+                   text.find_first_of("Ss") == std::string::npos)
+                : (slashes != 1)) {
+        return false;
+    }
+
+    rule.birth = masks[0];
+    rule.survive = masks[1];
+    rule.compile();
+
+    return true;
+}
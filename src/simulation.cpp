@@ -2,19 +2,7 @@
 
 Simulation::Simulation() {}
 
-Simulation::Simulation(int nLin, int nCol) {
-    // prepare_petri(nLin, nCol);
-    num_rows = nLin + 2;  // Two more rows to prevent error.
-    num_col = nCol + 2;   // Two more col to prevent error.
-
-    petri_dish.resize(num_rows);  // Define the number of lines
-
-    // In every row, create n columns with -1 (indicate empty space),
-    // thus this is equivalent to a num_rows x num_col.
-    for (int i = 0; i < num_rows; i++) {
-        petri_dish[i].assign(num_col, dead);
-    }
-}
+Simulation::Simulation(int nLin, int nCol) { prepare_petri(nLin, nCol); }
 
 Simulation::~Simulation() {}
 
@@ -22,99 +10,179 @@ void Simulation::prepare_petri(int size_row, int size_col) {
     num_rows = size_row + 2;  // Two more rows to prevent error.
     num_col = size_col + 2;   // Two more col to prevent error.
 
-    petri_dish.resize(num_rows);  // Define the number of lines
+    // One bit per cell, the halo rows and columns start dead.
+    petri_dish.resize(size_row, size_col);
+    next_dish.resize(size_row, size_col);
+    tiles.resize(size_row, petri_dish.row_words());
+}
 
-    // In every row, create n columns with -1 (indicate empty space),
-    // thus this is equivalent to a num_rows x num_col.
-    for (int i = 0; i < num_rows; i++) {
-        petri_dish[i].assign(num_col, dead);
+void Simulation::set_alive() {
+    // Copy the edges into the halo for torus and mirror boundaries.
+    petri_dish.fill_halo(boundary);
+
+    // Only the tiles next to a change are stepped.
+    active_tiles = tiles.activate();
+
+    if (!pool) {
+        step_band(0);
+        return;
     }
+
+    // One band of rows of tiles per worker. The front buffer is only read
+    // during the step, so the rows around a band are shared with its
+    // neighbours in place, and run() returns at the barrier once every band
+    // is done.
+    pool->run([this](int worker) { step_band(worker); });
 }
 
-int Simulation::surroundings(int i, int j) {
-    int n = 0;  // Number of neighbors
+void Simulation::step_band(int band) {
+    band_deltas[band] = GridDelta();
+    step_tiles(petri_dish, next_dish, tiles, band_begin(band),
+               band_begin(band + 1), kernel, rule, band_deltas[band]);
+}
+
+void Simulation::step_block_ahead() {
+    // process_events() counts the generation before game_over() checks
+    // maxgen, so num_gen can still reach options.maxgen - 1.
+    const long long left = options.maxgen - 1 - num_gen;
+    block_size = (int)std::min<long long>(options.tblock, left);
+    block_used = 0;
+
+    blocker->step(petri_dish, next_dish, block_size, kernel, rule,
+                  pool.get());
+}
+
+bool Simulation::needs_cells() {
+    const bool shown =
+        !options.headless ||
+        ((options.render_every > 0) &&
+         ((last_rendered < 0) ||
+          (num_gen - last_rendered >= options.render_every)));
+    const bool checkpoint =
+        checkpoint_writer && (num_gen % options.checkpoint_every == 0);
+
+    return shown || checkpoint || log_writer || image_writer ||
+           (history == History::last) || (history == History::full);
+}
+
+int Simulation::band_begin(int band) {
+    return (int)((long long)tiles.tiles_down() * band / workers());
+}
 
-    if ((i > getNumRows()) || (j > getNumCol())) {
-        std::cerr << "\n\033[0;31m>>> Error: out of range!\033[0m\n";
+void Simulation::log_generation() {
+    if (log_writer && !log_writer->append(petri_dish, num_gen)) {
+        std::cerr << "\n\033[0;31m>>> Error: could not write ["
+                  << options.outfile << "].\033[0m\n";
         exit(EXIT_FAILURE);
     }
 
-    if (petri_dish[i - 1][j - 1] == alive) {
-        n++;
+    if ((history == History::none) || (history == History::fingerprints)) {
+        return;  // The cells are not kept.
     }
 
-    if (petri_dish[i - 1][j] == alive) {
-        n++;
+    // History::last keeps its generations in a ring of history_size + 1
+    // slots, the current generation included.
+    if ((history == History::full) ||
+        ((int)log_master.size() <= history_size)) {
+        log_master.push_back(LoggedGeneration());
+        log_last = (int)log_master.size() - 1;
+    } else {
+        log_last = (log_last + 1) % (int)log_master.size();
+
+        // Forget the generation leaving the ring.
+        const LoggedGeneration &oldest = log_master[log_last];
+        seen.erase(oldest.fingerprint, oldest.gen);
     }
 
-    if (petri_dish[i - 1][j + 1] == alive) {
-        n++;
-    }
+    LoggedGeneration &current = log_master[log_last];
+    current.cells = petri_dish;  // Reuses the storage of the slot.
+    current.fingerprint = fingerprint;
+    current.gen = num_gen;
+}
 
-    if (petri_dish[i][j - 1] == alive) {
-        n++;
+void Simulation::remember(const Fingerprint &print, long long gen) {
+    const SnapshotEntry current = {print, gen};
+
+    // The window is a ring; History::fingerprints forgets the generation
+    // leaving it.
+    if (recent.size() < (std::size_t)fingerprint_window) {
+        recent.push_back(current);
+    } else {
+        const SnapshotEntry &oldest = recent[recent_next];
+        if (history == History::fingerprints) {
+            seen.erase(oldest.fingerprint, oldest.gen);
+        }
+        recent[recent_next] = current;
+        recent_next = (recent_next + 1) % recent.size();
     }
 
-    if (petri_dish[i][j + 1] == alive) {
-        n++;
+    if (history == History::fingerprints) {
+        if (far.gen < 0) {
+            far = current;
+        } else if (gen - far.gen >= far_span) {
+            far = current;
+            far_span *= 2;
+        }
     }
 
-    if (petri_dish[i + 1][j - 1] == alive) {
-        n++;
-    }
+    FingerprintIndex::Entry entry;
+    entry.fingerprint = print;
+    entry.gen = gen;
+    entry.slot = log_last;
+    seen.insert(entry);
+}
 
-    if (petri_dish[i + 1][j] == alive) {
-        n++;
+void Simulation::save_checkpoint() {
+    if (checkpoint_writer->failed()) {
+        std::cerr << "\n\033[0;31m>>> Error: could not write ["
+                  << options.checkpoint << "].\033[0m\n";
+        exit(EXIT_FAILURE);
     }
 
-    if (petri_dish[i + 1][j + 1] == alive) {
-        n++;
-    }
+    Snapshot *snapshot = checkpoint_writer->spare();
+    snapshot->cells = petri_dish;  // Reuses the storage of the last one.
+    snapshot->cell_char = cell_char;
+    snapshot->rule = rule;
+    snapshot->boundary = boundary;
+    snapshot->gen = num_gen;
+
+    // Only the ring of the last generations: the copy is bounded and reuses
+    // the storage of the last snapshot.
+    snapshot->seen.assign(recent.begin(), recent.end());
+    snapshot->far = far;
+    snapshot->far_span = far_span;
 
-    return n;
+    checkpoint_writer->submit();
 }
 
-void Simulation::set_alive() {
-    log_struct current_gen;  // Save the coordinates from this generation.
-    int idx_cell = 0;        // index of each cell (struct).
-
-    // First generation after read the file. Don't apply rules.
-    if (num_gen == 0) {
-        // Copy living cells from petri_dish to log of generation.
-        for (int i = 1; i <= getNumRows(); i++) {
-            for (int j = 1; j <= getNumCol(); j++) {
-                // Create and store the coords of living cells.
-                if (petri_dish[i][j] == alive) {
-                    current_gen.push_back(Cell());
-                    current_gen[idx_cell].x = i;
-                    current_gen[idx_cell].y = j;
-                    idx_cell++;
-                }
-            }
-        }
-    } else {  // Apply rules to define cell status.
-
-        // Copy living cells from petri_dish to log of generation.
-        for (int i = 1; i <= getNumRows(); i++) {
-            for (int j = 1; j <= getNumCol(); j++) {
-                if (surroundings(i, j) == 3) {
-                    current_gen.push_back(Cell());
-                    current_gen[idx_cell].x = i;
-                    current_gen[idx_cell].y = j;
-                    idx_cell++;
-
-                } else if (petri_dish[i][j] == alive) {
-                    if ((surroundings(i, j) <= 3) &&
-                        (surroundings(i, j) >= 2)) {
-                        current_gen.push_back(Cell());
-                        current_gen[idx_cell].x = i;
-                        current_gen[idx_cell].y = j;
-                        idx_cell++;
-                    }
-                }
-            }
+bool Simulation::parse_history() {
+    const std::string last = "last-";
+
+    // The window of the checkpoints, whatever the policy.
+    recent.reserve(fingerprint_window);
+
+    if (options.history == "none") {
+        history = History::none;
+    } else if (options.history == "fingerprints") {
+        history = History::fingerprints;
+
+        // The ring never holds more generations, so `seen` never grows.
+        seen.reserve((std::size_t)fingerprint_window);
+    } else if (options.history == "full") {
+        history = History::full;
+    } else if (options.history.compare(0, last.size(), last) == 0) {
+        history = History::last;
+        history_size = atoi(options.history.c_str() + last.size());
+
+        if (history_size < 1) {
+            return false;
         }
+
+        // The ring never holds more generations, so `seen` never grows.
+        seen.reserve((std::size_t)history_size + 1);
+    } else {
+        return false;
     }
-    log_master.push_back(
-        current_gen);  // Push to the log_master the current generation.
+
+    return true;
 }
@@ -0,0 +1,273 @@
+#include "../include/sparse_board.h"
+
+#include <algorithm>  // std::sort, std::unique, std::lower_bound, std::fill
+#include <cstring>    // std::memset
+
+namespace {
+
+//! Tile coordinate of a plane coordinate (rounded towards -infinity).
+inline std::int64_t tile_of(std::int64_t x) {
+    return (x >= 0) ? x / SparseBoard::tile_side
+                    : -((-x + SparseBoard::tile_side - 1) /
+                        SparseBoard::tile_side);
+}
+
+inline std::int64_t key_row(std::uint64_t k) {
+    return (std::int64_t)(std::int32_t)(k >> 32);
+}
+
+inline std::int64_t key_col(std::uint64_t k) {
+    return (std::int64_t)(std::int32_t)(k & 0xffffffffu);
+}
+
+const int side = SparseBoard::tile_side;
+
+//! Hash of the row r of the tile k, as the word of a grid at its place.
+inline Fingerprint row_fingerprint(std::uint64_t k, int r,
+                                   std::uint64_t word) {
+    return word_fingerprint((std::uint64_t)(key_row(k) * side + r),
+                            (std::uint32_t)key_col(k), word);
+}
+
+}  // namespace
+
+SparseBoard::SparseBoard(step_kernel kernel, const Rule &rule)
+    : kernel(kernel), rule(rule) {}
+
+std::uint64_t SparseBoard::key(std::int64_t ty, std::int64_t tx) {
+    return ((std::uint64_t)(std::uint32_t)ty << 32) | (std::uint32_t)tx;
+}
+
+const SparseBoard::Tile *SparseBoard::find(std::uint64_t k) const {
+    const std::size_t mask = index.size() - 1;
+
+    for (std::size_t i = mix64(k) & mask; index[i] != 0; i = (i + 1) & mask) {
+        if (keys[index[i] - 1] == k) {
+            return &tiles[index[i] - 1];
+        }
+    }
+
+    return nullptr;
+}
+
+void SparseBoard::index_tiles() {
+    // At most half full, so that the probes stay short.
+    std::size_t capacity = 16;
+    while (capacity < 2 * keys.size()) {
+        capacity *= 2;
+    }
+
+    if (index.size() < capacity) {
+        index.resize(capacity);
+    }
+    std::fill(index.begin(), index.end(), 0);
+
+    const std::size_t mask = index.size() - 1;
+    for (std::size_t t = 0; t < keys.size(); t++) {
+        std::size_t i = mix64(keys[t]) & mask;
+        while (index[i] != 0) {
+            i = (i + 1) & mask;
+        }
+        index[i] = (std::uint32_t)(t + 1);
+    }
+}
+
+void SparseBoard::load(const Grid &grid) {
+    keys.clear();
+    alive_cells = 0;
+
+    for (int i = 1; i <= grid.rows(); i++) {
+        for (int j = 1; j <= grid.cols(); j++) {
+            if (grid.get(i, j) == 1) {
+                keys.push_back(key(tile_of(i), tile_of(j)));
+            }
+        }
+    }
+
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    tiles.assign(keys.size(), Tile());
+    index_tiles();
+
+    for (int i = 1; i <= grid.rows(); i++) {
+        for (int j = 1; j <= grid.cols(); j++) {
+            if (grid.get(i, j) == 1) {
+                const std::uint64_t k = key(tile_of(i), tile_of(j));
+                Tile &tile = tiles[std::lower_bound(keys.begin(), keys.end(),
+                                                    k) -
+                                   keys.begin()];
+                tile.rows[i % side] |= std::uint64_t(1) << (j % side);
+                alive_cells++;
+            }
+        }
+    }
+
+    hash = Fingerprint();
+    for (std::size_t t = 0; t < keys.size(); t++) {
+        for (int r = 0; r < side; r++) {
+            hash ^= row_fingerprint(keys[t], r, tiles[t].rows[r]);
+        }
+    }
+}
+
+void SparseBoard::find_candidates() {
+    candidates.clear();
+
+    for (std::size_t t = 0; t < keys.size(); t++) {
+        const std::int64_t ty = key_row(keys[t]);
+        const std::int64_t tx = key_col(keys[t]);
+        const Tile &tile = tiles[t];
+
+        std::uint64_t left = 0, right = 0;  // Cells of columns 0 and 63.
+        for (int r = 0; r < side; r++) {
+            left |= tile.rows[r] & 1u;
+            right |= tile.rows[r] >> (side - 1);
+        }
+        const bool top = tile.rows[0] != 0;
+        const bool bottom = tile.rows[side - 1] != 0;
+
+        candidates.push_back(keys[t]);
+
+        // Births can only happen next to the edges with living cells.
+        const bool edge[3][3] = {
+            {top && ((tile.rows[0] & 1u) != 0), top,
+             top && ((tile.rows[0] >> (side - 1)) != 0)},
+            {left != 0, false, right != 0},
+            {bottom && ((tile.rows[side - 1] & 1u) != 0), bottom,
+             bottom && ((tile.rows[side - 1] >> (side - 1)) != 0)}};
+
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                if (edge[dy + 1][dx + 1]) {
+                    candidates.push_back(key(ty + dy, tx + dx));
+                }
+            }
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                     candidates.end());
+}
+
+void SparseBoard::step_tile(std::uint64_t k, Result &next) const {
+    const std::int64_t ty = key_row(k), tx = key_col(k);
+
+    // The 3x3 tiles around, as a 66-row grid of words between two guard
+    // words: word 1 is the west tile, 2 the tile itself and 3 the east one.
+    const std::size_t stride = 5;
+    std::uint64_t cells[side + 2][stride];
+    std::memset(cells, 0, sizeof(cells));
+
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            const Tile *tile = find(key(ty + dy, tx + dx));
+            if (tile == nullptr) {
+                continue;
+            }
+
+            // Only the row next to the tile is needed from above and below.
+            const int first = (dy == -1) ? side - 1 : 0;
+            const int last = (dy == 1) ? 0 : side - 1;
+            for (int r = first; r <= last; r++) {
+                cells[1 + dy * side + r][2 + dx] = tile->rows[r];
+            }
+        }
+    }
+
+    std::uint64_t out[side + 2][stride];
+    const std::uint64_t mask[stride] = {0, 0, ~std::uint64_t(0), 0, 0};
+
+    StepSpan span;
+    span.front = &cells[0][0];
+    span.back = &out[0][0];
+    span.mask = mask;
+    span.stride = stride;
+    span.row_begin = 1;
+    span.row_end = side + 1;
+    span.word_begin = 2;
+    span.word_end = 3;
+    span.birth = rule.birth;
+    span.survive = rule.survive;
+    kernel(span);
+
+    // Only the rows that changed are hashed; a new tile starts dead.
+    const Tile *before = find(k);
+    std::uint64_t any = 0;
+    next.delta = Fingerprint();
+    for (int r = 0; r < side; r++) {
+        const std::uint64_t old_row = before ? before->rows[r] : 0;
+        next.tile.rows[r] = out[r + 1][2];
+        any |= next.tile.rows[r];
+
+        if (next.tile.rows[r] != old_row) {
+            next.delta ^= row_fingerprint(k, r, old_row);
+            next.delta ^= row_fingerprint(k, r, next.tile.rows[r]);
+        }
+    }
+
+    next.alive = any != 0;
+}
+
+void SparseBoard::step(ThreadPool *pool) {
+    find_candidates();
+    results.resize(candidates.size());
+
+    if (pool == nullptr) {
+        for (std::size_t c = 0; c < candidates.size(); c++) {
+            step_tile(candidates[c], results[c]);
+        }
+    } else {
+        const std::size_t workers = (std::size_t)pool->size();
+
+        // Two words of captures stay in the std::function: no allocation.
+        pool->run([this, workers](int worker) {
+            const std::size_t n = candidates.size();
+            for (std::size_t c = n * worker / workers;
+                 c < n * (worker + 1) / workers; c++) {
+                step_tile(candidates[c], results[c]);
+            }
+        });
+    }
+
+    // Keep the tiles that still have living cells, drop the others. The
+    // candidates are sorted, so are the tiles.
+    keys.clear();
+    tiles.clear();
+    alive_cells = 0;
+    for (std::size_t c = 0; c < candidates.size(); c++) {
+        hash ^= results[c].delta;
+
+        if (results[c].alive) {
+            const Tile &tile = results[c].tile;
+            for (int r = 0; r < side; r++) {
+                alive_cells += __builtin_popcountll(tile.rows[r]);
+            }
+            keys.push_back(candidates[c]);
+            tiles.push_back(tile);
+        }
+    }
+    index_tiles();
+}
+
+void SparseBoard::render(Grid &grid) const {
+    grid.clear();
+
+    for (std::size_t t = 0; t < keys.size(); t++) {
+        const std::int64_t ty = key_row(keys[t]);
+        const std::int64_t tx = key_col(keys[t]);
+
+        // A tile is exactly one word of the grid rows.
+        if ((tx < 0) || (tx >= (std::int64_t)grid.row_words())) {
+            continue;
+        }
+
+        for (int r = 0; r < side; r++) {
+            const std::int64_t i = ty * side + r;
+            if ((i >= 1) && (i <= grid.rows())) {
+                grid.row((int)i)[tx] =
+                    tiles[t].rows[r] & grid.interior_mask()[tx];
+            }
+        }
+    }
+}
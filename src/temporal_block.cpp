@@ -0,0 +1,144 @@
+#include "../include/temporal_block.h"
+
+#include <algorithm>  // std::min, std::max, std::fill
+
+void TemporalBlocker::step(const Grid &front, Grid &back, int generations,
+                           step_kernel kernel, const Rule &rule,
+                           ThreadPool *pool) {
+    this->front = &front;
+    this->back = &back;
+    this->generations = generations;
+    this->kernel = kernel;
+    this->rule = rule;
+
+    const int workers = pool ? pool->size() : 1;
+    scratch.resize(workers);
+    for (Scratch &s : scratch) {
+        s.deltas.assign(generations, GridDelta());
+    }
+
+    if (pool) {
+        pool->run([this, workers](int worker) { step_band(worker, workers); });
+    } else {
+        step_band(0, 1);
+    }
+
+    deltas.assign(generations, GridDelta());
+    for (const Scratch &s : scratch) {
+        for (int t = 0; t < generations; t++) {
+            deltas[t].fingerprint ^= s.deltas[t].fingerprint;
+            deltas[t].population += s.deltas[t].population;
+        }
+    }
+}
+
+void TemporalBlocker::step_band(int worker, int workers) {
+    const int down = (front->rows() + tile_rows - 1) / tile_rows;
+    const std::size_t across =
+        (front->row_words() + tile_words - 1) / tile_words;
+
+    for (int ty = down * worker / workers; ty < down * (worker + 1) / workers;
+         ty++) {
+        for (std::size_t tx = 0; tx < across; tx++) {
+            step_tile(scratch[worker], ty, tx);
+        }
+    }
+}
+
+void TemporalBlocker::step_tile(Scratch &s, int ty, std::size_t tx) {
+    const int k = generations;
+    const int rows = front->rows();
+    const long long words = (long long)front->row_words();
+
+    // Rows [r0, r1) and words [w0, w1) of the tile.
+    const int r0 = 1 + ty * tile_rows;
+    const int r1 = std::min(r0 + tile_rows, rows + 1);
+    const long long w0 = (long long)(tx * tile_words);
+    const long long w1 = std::min(w0 + (long long)tile_words, words);
+
+    // Scratch row i is row top + i - 1 of the board, scratch word x is word
+    // w0 - 2 + x: a zero row and word on the outside, then the halo.
+    const int top = r0 - k;
+    const int height = (r1 - r0) + 2 * k + 2;
+    const std::size_t stride = (std::size_t)(w1 - w0) + 4;
+
+    // Rows out of the board stay dead: they are not stepped.
+    const int row_begin = std::max(1, 2 - top);
+    const int row_end = std::min(height - 1, rows - top + 2);
+
+    // The zero words on the sides are never written; the rows that are not
+    // stepped are cleared, they may hold another tile.
+    const std::size_t size = (std::size_t)height * stride;
+    for (std::vector<std::uint64_t> &cells : s.cells) {
+        if (cells.size() != size) {
+            cells.assign(size, 0);
+        }
+        std::fill(cells.begin(), cells.begin() + row_begin * stride, 0);
+        std::fill(cells.begin() + row_end * stride, cells.end(), 0);
+    }
+    s.mask.assign(stride, 0);
+
+    for (std::size_t x = 1; x + 1 < stride; x++) {
+        const long long w = w0 - 2 + (long long)x;
+        if ((w >= 0) && (w < words)) {
+            s.mask[x] = front->interior_mask()[w];
+        }
+    }
+
+    for (int i = row_begin; i < row_end; i++) {
+        const std::uint64_t *row = front->row(top + i - 1);
+        std::uint64_t *copy = &s.cells[0][(std::size_t)i * stride];
+
+        for (std::size_t x = 1; x + 1 < stride; x++) {
+            const long long w = w0 - 2 + (long long)x;
+            copy[x] = ((w >= 0) && (w < words)) ? (row[w] & s.mask[x]) : 0;
+        }
+    }
+
+    StepSpan span;
+    span.mask = s.mask.data();
+    span.stride = stride;
+    span.row_begin = row_begin;
+    span.row_end = row_end;
+    span.word_begin = 1;
+    span.word_end = stride - 1;
+    span.birth = rule.birth;
+    span.survive = rule.survive;
+
+    int cur = 0;
+    for (int t = 0; t < k; t++) {
+        span.front = s.cells[cur].data();
+        span.back = s.cells[1 - cur].data();
+        kernel(span);
+
+        // The tile itself is exact: hash the words that changed.
+        GridDelta &delta = s.deltas[t];
+        for (int i = k + 1; i < k + 1 + (r1 - r0); i++) {
+            const std::uint64_t *before = span.front + (std::size_t)i * stride;
+            const std::uint64_t *after = span.back + (std::size_t)i * stride;
+
+            for (std::size_t x = 2; x < stride - 2; x++) {
+                if (before[x] != after[x]) {
+                    const std::uint64_t w = (std::uint64_t)(w0 - 2) + x;
+                    delta.fingerprint ^=
+                        word_fingerprint(top + i - 1, w, before[x]);
+                    delta.fingerprint ^=
+                        word_fingerprint(top + i - 1, w, after[x]);
+                    delta.population += __builtin_popcountll(after[x]) -
+                                        __builtin_popcountll(before[x]);
+                }
+            }
+        }
+
+        cur = 1 - cur;
+    }
+
+    for (int i = k + 1; i < k + 1 + (r1 - r0); i++) {
+        const std::uint64_t *cells = &s.cells[cur][(std::size_t)i * stride];
+        std::uint64_t *row = back->row(top + i - 1);
+
+        for (std::size_t x = 2; x < stride - 2; x++) {
+            row[w0 - 2 + (long long)x] = cells[x];
+        }
+    }
+}
@@ -0,0 +1,125 @@
+#include "../include/terminal_renderer.h"
+
+#include <unistd.h>  // write(), STDOUT_FILENO
+
+#include <cerrno>  // errno, EINTR
+#include <cstdio>  // std::snprintf
+
+namespace {
+
+const char *border_color = "\033[1;37m";  //!< White, bold.
+const char *cell_color = "\033[1;32m";    //!< Green, bold.
+const char *no_color = "\033[0m";
+
+//! Cells closer than this are redrawn as one run.
+const int max_gap = 4;
+
+}  // namespace
+
+bool write_all(int fd, const char *data, std::size_t size) {
+    while (size > 0) {
+        const ssize_t n = write(fd, data, size);
+
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        data += n;
+        size -= (std::size_t)n;
+    }
+
+    return true;
+}
+
+void TerminalRenderer::move_to(int row, int col) {
+    char seq[32];
+    const int n = std::snprintf(seq, sizeof(seq), "\033[%d;%dH", row, col);
+    buffer.append(seq, (std::size_t)n);
+}
+
+void TerminalRenderer::draw_borders(int rows, int cols) {
+    const std::string line((std::size_t)cols + 4, '-');
+
+    buffer += "\033[2J";  // Clear the screen.
+
+    // Top border on row 2, the cells on rows 3.., bottom border after them.
+    move_to(2, 1);
+    buffer += border_color;
+    buffer += line;
+    for (int i = 1; i <= rows; i++) {
+        move_to(i + 2, 1);
+        buffer += '|';
+        move_to(i + 2, cols + 4);
+        buffer += '|';
+    }
+    move_to(rows + 3, 1);
+    buffer += line;
+    buffer += no_color;
+}
+
+void TerminalRenderer::draw_run(const Grid &grid, char cell_char, int i,
+                                int j0, int j1) {
+    // Cell (i, j) is on the row i + 2 and column j + 2 of the screen.
+    move_to(i + 2, j0 + 2);
+    buffer += cell_color;
+    for (int j = j0; j <= j1; j++) {
+        buffer += grid.get(i, j) ? cell_char : ' ';
+    }
+    buffer += no_color;
+}
+
+void TerminalRenderer::draw(const Grid &grid, char cell_char,
+                            const std::string &title) {
+    buffer.clear();  // Keeps the storage of the previous frames.
+
+    // First frame or new size: start from an empty board.
+    if (!drawn || (grid.rows() != previous.rows()) ||
+        (grid.cols() != previous.cols())) {
+        previous.resize(grid.rows(), grid.cols());
+        buffer.reserve((std::size_t)(grid.rows() + 4) * (grid.cols() + 16));
+        draw_borders(grid.rows(), grid.cols());
+        drawn = true;
+    }
+
+    move_to(1, 1);
+    buffer += "\033[2K";  // Clear the line.
+    buffer += title;
+
+    const std::uint64_t *mask = grid.interior_mask();
+    for (int i = 1; i <= grid.rows(); i++) {
+        const std::uint64_t *now = grid.row(i);
+        const std::uint64_t *before = previous.row(i);
+        int run_begin = -1, run_end = -1;
+
+        for (std::size_t w = 0; w < grid.row_words(); w++) {
+            std::uint64_t diff = (now[w] ^ before[w]) & mask[w];
+
+            while (diff != 0) {
+                const int j = (int)(w * 64) + __builtin_ctzll(diff);
+                diff &= diff - 1;
+
+                if ((run_begin >= 0) && (j - run_end <= max_gap)) {
+                    run_end = j;
+                } else {
+                    if (run_begin >= 0) {
+                        draw_run(grid, cell_char, i, run_begin, run_end);
+                    }
+                    run_begin = run_end = j;
+                }
+            }
+        }
+
+        if (run_begin >= 0) {
+            draw_run(grid, cell_char, i, run_begin, run_end);
+        }
+    }
+
+    // Leave the cursor under the board.
+    move_to(grid.rows() + 4, 1);
+    write_all(STDOUT_FILENO, buffer.data(), buffer.size());
+
+    previous = grid;  // Reuses the storage.
+}
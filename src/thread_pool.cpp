@@ -0,0 +1,62 @@
+#include "../include/thread_pool.h"
+
+ThreadPool::ThreadPool(int nThreads) {
+    for (int i = 1; i < nThreads; i++) {
+        threads.emplace_back(&ThreadPool::work, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stop = true;
+    }
+    start.notify_all();
+
+    for (auto &t : threads) {
+        t.join();
+    }
+}
+
+void ThreadPool::run(const std::function<void(int)> &task) {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        job = &task;
+        pending = (int)threads.size();
+        round++;
+    }
+    start.notify_all();
+
+    task(0);  // The caller is worker 0.
+
+    // Barrier: wait for the other workers.
+    std::unique_lock<std::mutex> guard(lock);
+    done.wait(guard, [this] { return pending == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::work(int worker) {
+    unsigned long seen = 0;  // Last round run by this worker.
+
+    for (;;) {
+        const std::function<void(int)> *task;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            start.wait(guard, [&] { return stop || (round != seen); });
+
+            if (stop) {
+                return;
+            }
+
+            seen = round;
+            task = job;
+        }
+
+        (*task)(worker);
+
+        std::lock_guard<std::mutex> guard(lock);
+        if (--pending == 0) {
+            done.notify_one();
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#include "../include/tile_map.h"
+
+#include <algorithm>  // std::fill
+
+void TileMap::resize(int nRows, std::size_t nWords) {
+    down = (nRows + tile_rows - 1) / tile_rows;
+    across = nWords;
+
+    changed_tiles.assign((std::size_t)down * across, 1);
+    active_tiles.assign((std::size_t)down * across, 0);
+}
+
+void TileMap::set_wrap(bool wrap_around, std::size_t last_tx) {
+    wrap = wrap_around;
+    last = last_tx;
+}
+
+void TileMap::mark_all() {
+    std::fill(changed_tiles.begin(), changed_tiles.end(), 1);
+}
+
+long long TileMap::activate() {
+    long long count = 0;
+
+    for (int ty = 0; ty < down; ty++) {
+        // Rows of tiles around, wrapping on a torus.
+        int ys[3] = {ty - 1, ty, ty + 1};
+        for (auto &y : ys) {
+            if (wrap) {
+                y = (y + down) % down;
+            }
+        }
+
+        for (std::size_t tx = 0; tx < across; tx++) {
+            // Columns of tiles around; on a torus, the first and the last
+            // visible ones are neighbours.
+            std::size_t xs[4] = {tx, tx, tx, tx};
+            int nx = 1;
+            if (tx > 0) {
+                xs[nx++] = tx - 1;
+            }
+            if (tx + 1 < across) {
+                xs[nx++] = tx + 1;
+            }
+            if (wrap && (tx == 0)) {
+                xs[nx++] = last;
+            } else if (wrap && (tx == last)) {
+                xs[nx++] = 0;
+            }
+
+            std::uint8_t any = 0;
+            for (int y : ys) {
+                if ((y < 0) || (y >= down)) {
+                    continue;
+                }
+
+                const std::uint8_t *row =
+                    changed_tiles.data() + (std::size_t)y * across;
+                for (int x = 0; x < nx; x++) {
+                    any |= row[xs[x]];
+                }
+            }
+
+            active_tiles[(std::size_t)ty * across + tx] = any;
+            count += any;
+        }
+    }
+
+    return count;
+}
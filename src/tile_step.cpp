@@ -0,0 +1,65 @@
+#include "../include/tile_step.h"
+
+#include <algorithm>  // std::min, std::max
+
+int surroundings(const Grid &grid, int i, int j) {
+    // Grid::get() is 1 for a living cell, 0 for a dead one.
+    return grid.get(i - 1, j - 1) + grid.get(i - 1, j) +
+           grid.get(i - 1, j + 1) + grid.get(i, j - 1) + grid.get(i, j + 1) +
+           grid.get(i + 1, j - 1) + grid.get(i + 1, j) +
+           grid.get(i + 1, j + 1);
+}
+
+void step_tiles(const Grid &front, Grid &back, TileMap &tiles, int ty_begin,
+                int ty_end, step_kernel kernel, const Rule &rule,
+                GridDelta &delta) {
+    StepSpan span = full_span(front, back);
+    span.birth = rule.birth;
+    span.survive = rule.survive;
+
+    for (int ty = ty_begin; ty < ty_end; ty++) {
+        span.row_begin = tiles.first_row(ty);
+        span.row_end =
+            std::min(span.row_begin + TileMap::tile_rows, front.rows() + 1);
+
+        for (std::size_t tx = 0; tx < tiles.tiles_across();) {
+            if (!tiles.active(ty, tx)) {
+                tiles.set_changed(ty, tx, false);
+                tx++;
+                continue;
+            }
+
+            // Step the whole run of active tiles at once.
+            std::size_t end = tx + 1;
+            while ((end < tiles.tiles_across()) && tiles.active(ty, end)) {
+                end++;
+            }
+            span.word_begin = tx;
+            span.word_end = end;
+
+            if (kernel != nullptr) {
+                kernel(span);  // 64 to 512 cells at a time.
+            } else {
+                // Reference code, cell by cell.
+                const int col_begin = std::max(1, (int)tx * 64);
+                const int col_end = std::min(front.cols() + 1, (int)end * 64);
+
+                for (int i = span.row_begin; i < span.row_end; i++) {
+                    for (int j = col_begin; j < col_end; j++) {
+                        int n = surroundings(front, i, j);
+
+                        back.set(i, j, rule.next[front.get(i, j)][n]);
+                    }
+                }
+            }
+
+            // Hash only the words that changed, while they are cached.
+            for (; tx < end; tx++) {
+                tiles.set_changed(ty, tx,
+                                  add_block_delta(front, back, span.row_begin,
+                                                  span.row_end, tx, tx + 1,
+                                                  delta));
+            }
+        }
+    }
+}
@@ -0,0 +1,163 @@
+/*!
+ * \file alloc_test.cpp
+ * \brief Checks that the loop of glife stops allocating once warm (make
+ * test).
+ *
+ * Drives Simulation as main() does and counts the heap allocations of the
+ * generations after the warm-up, the rows of the grids included: there must
+ * be none. A glider crossing an empty board never repeats, so the run does
+ * not end early.
+ *
+ * The default history is counted over thousands of generations, through
+ * the wrap of its ring of fingerprints and the first move of the far one,
+ * on the grid and sparse engines. The cells of the last K generations and
+ * the generation log are counted too.
+ */
+
+// C
+#include <fcntl.h>   // open()
+#include <getopt.h>  // optind
+#include <unistd.h>  // dup(), dup2(), close(), mkstemp(), unlink()
+
+#include <cstdio>   // std::fflush
+#include <cstdlib>  // EXIT_SUCCESS, EXIT_FAILURE
+
+// C++
+#include <fstream>   // std::ofstream
+#include <iostream>  // std::cout, std::cerr
+#include <string>    // std::string
+#include <vector>    // std::vector
+
+#include "../include/simulation.h"
+#include "count_allocations.h"
+
+namespace {
+
+//! Side of the board, long enough for the glider to cross it.
+const int side = 2560;
+
+//! Run of glife to count.
+struct Case {
+    std::string what;               //!< Name in the report.
+    std::vector<std::string> args;  //!< Options, the pattern file excepted.
+    long long warm_gens;            //!< Generations stepped before counting.
+    long long last_gen;             //!< Generation the counting stops at.
+};
+
+/*!@brief Run a simulation and count the allocations once warm.
+ *@param Options of glife, the pattern file last.
+ *@param Generations stepped before counting.
+ *@param Generation the counting stops at.
+ *@return Allocations made by the generations warm_gens to last_gen, -1 if
+ *the simulation ended before.
+ */
+long long count_warm_allocations(std::vector<std::string> args,
+                                 long long warm_gens, long long last_gen) {
+    std::vector<char *> argv;
+    for (std::string &arg : args) {
+        argv.push_back(&arg[0]);
+    }
+    argv.push_back(nullptr);
+
+    // Simulation talks a lot: keep the report of the test readable.
+    std::cout.flush();
+    std::fflush(stdout);
+    const int saved_out = dup(STDOUT_FILENO), saved_err = dup(STDERR_FILENO);
+    const int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+    dup2(null, STDERR_FILENO);
+    close(null);
+
+    long long counted = -1;
+    {
+        Simulation game;
+        optind = 0;  // initialize() parses its own command line.
+        game.initialize((int)args.size(), argv.data());
+        game.render();
+
+        long long start = 0;
+        for (long long gen = 0; !game.game_over(); gen++) {
+            if (gen == warm_gens) {
+                start = allocations.load();
+            }
+            if (gen == last_gen) {
+                counted = allocations.load() - start;
+                break;
+            }
+
+            game.process_events();
+            game.update();
+            game.render();
+        }
+    }
+
+    std::cout.flush();
+    std::fflush(stdout);
+    dup2(saved_out, STDOUT_FILENO);
+    dup2(saved_err, STDERR_FILENO);
+    close(saved_out);
+    close(saved_err);
+
+    return counted;
+}
+
+}  // namespace
+
+int main() {
+    // A glider in the top left corner of an empty board, heading down right.
+    char path[] = "/tmp/glife_alloc_XXXXXX";
+    char log_path[] = "/tmp/glife_alloc_log_XXXXXX";
+    const int fd = mkstemp(path), log_fd = mkstemp(log_path);
+    if ((fd < 0) || (log_fd < 0)) {
+        std::cerr << "Could not create the files of the test\n";
+        return EXIT_FAILURE;
+    }
+    close(fd);
+    close(log_fd);
+    {
+        std::ofstream file(path);
+        file << side << " " << side << "\n*\n"
+             << ".*\n"
+             << "..*\n"
+             << "***\n";
+    }
+
+    // The ring of the default history wraps at generation 4096, where the
+    // far fingerprint moves on for the first time.
+    const Case cases[] = {
+        {"grid engine, default history", {"--engine", "grid"}, 500, 9000},
+        {"sparse engine, default history", {"--engine", "sparse"}, 500, 9000},
+        {"grid engine, last-16 history", {"--history", "last-16"}, 100, 2000},
+        {"grid engine, generation log", {"--outfile", log_path}, 100, 2000},
+    };
+
+    int failures = 0;
+    for (const Case &test : cases) {
+        // game_over() stops the loop once maxgen - 1 generations are stepped.
+        std::vector<std::string> args = {"glife", "--headless", "--maxgen",
+                                         std::to_string(test.last_gen + 2)};
+        args.insert(args.end(), test.args.begin(), test.args.end());
+        args.push_back(path);
+
+        const long long counted =
+            count_warm_allocations(args, test.warm_gens, test.last_gen);
+
+        const std::string what = test.what + ", generations " +
+                                 std::to_string(test.warm_gens) + " to " +
+                                 std::to_string(test.last_gen);
+        if (counted != 0) {
+            failures++;
+            std::cerr << "FAIL " << what << ": "
+                      << (counted < 0 ? "the run ended early"
+                                      : std::to_string(counted) +
+                                            " allocations")
+                      << "\n";
+        } else {
+            std::cout << "ok " << what << ": no allocation\n";
+        }
+    }
+
+    unlink(path);
+    unlink(log_path);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
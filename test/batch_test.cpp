@@ -0,0 +1,131 @@
+/*!
+ * \file batch_test.cpp
+ * \brief Checks BatchRunner against an Engine per board (make test).
+ *
+ * Random soups of ragged sizes, from a single cell to boards wider than two
+ * words, are packed together and stepped, then compared with each board
+ * stepped on its own by an Engine: the gutter columns, the rows cleared
+ * below the boards lower than their shelf and the shelves shared between
+ * threads must leave every board as it would be alone.
+ */
+
+// C
+#include <cstdlib>  // EXIT_SUCCESS, EXIT_FAILURE
+
+// C++
+#include <iostream>  // std::cout, std::cerr
+#include <memory>    // std::unique_ptr
+#include <random>    // std::mt19937_64
+#include <string>    // std::string
+#include <vector>    // std::vector
+
+#include "../include/batch_runner.h"
+#include "../include/board.h"
+#include "../include/engine.h"
+#include "../include/rule.h"
+
+namespace {
+
+//! Boards of each batch.
+const int boards_per_batch = 200;
+
+//! Generations stepped by each batch, in calls of 1 to 4 generations.
+const int generations = 48;
+
+//! Random soup of a random size.
+Board soup(std::mt19937_64 &random) {
+    // Mostly small boards, a few across several words.
+    std::uniform_int_distribution<int> small(1, 24), large(1, 150);
+    const int rows = (random() % 4 == 0) ? large(random) : small(random);
+    const int cols = (random() % 4 == 0) ? large(random) : small(random);
+
+    Board board(rows, cols);
+    std::bernoulli_distribution alive(0.4);
+    for (int i = 1; i <= rows; i++) {
+        for (int j = 1; j <= cols; j++) {
+            board.set(i, j, alive(random));
+        }
+    }
+
+    return board;
+}
+
+/*!@brief Step a batch and an Engine per board, and compare them.
+ *@return Number of boards that differ at some point.
+ */
+int compare(const std::vector<Board> &boards, const EngineConfig &config,
+            std::mt19937_64 &random) {
+    BatchRunner batch;
+    if (!batch.load(boards, config)) {
+        return (int)boards.size();
+    }
+
+    std::vector<std::unique_ptr<Engine>> engines;
+    for (const Board &board : boards) {
+        engines.emplace_back(new Engine());
+        engines.back()->load(board, config);
+    }
+
+    std::vector<bool> failed(boards.size(), false);
+    std::uniform_int_distribution<int> step(1, 4);
+    while (batch.generation() < generations) {
+        const int gens = step(random);
+        batch.step(gens);
+
+        for (std::size_t k = 0; k < boards.size(); k++) {
+            engines[k]->step(gens);
+            if (!batch.board((int)k).cells().same_cells(
+                    engines[k]->cells()) ||
+                (batch.population((int)k) != engines[k]->population())) {
+                failed[k] = true;
+            }
+        }
+    }
+
+    int failures = 0;
+    for (bool f : failed) {
+        failures += f ? 1 : 0;
+    }
+    return failures;
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937_64 random(20240602);
+
+    const char *kernels[] = {"auto", "scalar"};
+    const char *rules[] = {"B3/S23", "B36/S23", "B2/S"};
+    const int threads[] = {1, 3};
+
+    int checks = 0, failures = 0;
+    for (const char *kernel : kernels) {
+        for (const char *rule_name : rules) {
+            for (int nthreads : threads) {
+                std::vector<Board> boards;
+                for (int b = 0; b < boards_per_batch; b++) {
+                    boards.push_back(soup(random));
+                }
+
+                EngineConfig config;
+                config.kernel = kernel;
+                config.threads = nthreads;
+                parse_rule(rule_name, config.rule);
+
+                const int failed = compare(boards, config, random);
+                checks++;
+                if (failed != 0) {
+                    failures++;
+                    std::cerr << "FAIL " << kernel << " " << rule_name << " "
+                              << nthreads << " thread(s): " << failed << "/"
+                              << boards.size() << " boards differ\n";
+                }
+            }
+        }
+    }
+
+    std::cout << "batch_test: " << checks - failures << "/" << checks
+              << " batches of " << boards_per_batch
+              << " boards match their own Engine\n";
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
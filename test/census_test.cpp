@@ -0,0 +1,184 @@
+/*!
+ * \file census_test.cpp
+ * \brief Checks the census of a board of known objects (make test).
+ *
+ * Gliders and LWSS heading every way (mirrored and transposed), blinkers,
+ * beehives and boats in several orientations, a block and a pulsar are
+ * counted on 1 to 6 threads. Some of them lie across the seams between the
+ * bands of rows of 2, 3 and 4 threads, and must still count as one object.
+ * Each spaceship must report the way it moves on the board.
+ */
+
+// C
+#include <cstdlib>  // EXIT_SUCCESS, EXIT_FAILURE
+
+// C++
+#include <algorithm>  // std::sort
+#include <iostream>   // std::cout, std::cerr
+#include <memory>     // std::unique_ptr
+#include <string>     // std::string
+#include <tuple>      // std::tie
+#include <vector>     // std::vector
+
+#include "../include/board.h"
+#include "../include/census.h"
+#include "../include/kernel.h"
+#include "../include/rule.h"
+#include "../include/thread_pool.h"
+
+namespace {
+
+//! Size of the board: the seams of 2, 3 and 4 threads start rows 41, 27
+//! and 54, 21, 41 and 61.
+const int board_rows = 80, board_cols = 140;
+
+//! Object expected in the census.
+struct Expected {
+    std::string name;
+    int dx, dy;
+    long long count;
+
+    bool operator<(const Expected &other) const {
+        return std::tie(name, dx, dy, count) <
+               std::tie(other.name, other.dx, other.dy, other.count);
+    }
+
+    bool operator==(const Expected &other) const {
+        return std::tie(name, dx, dy, count) ==
+               std::tie(other.name, other.dx, other.dy, other.count);
+    }
+};
+
+const std::vector<std::string> glider = {".O.", "..O", "OOO"};  // (1, 1)
+const std::vector<std::string> lwss = {".OOOO", "O...O", "....O",
+                                       "O..O."};  // (2, 0)
+const std::vector<std::string> blinker = {"OOO"};
+const std::vector<std::string> block = {"OO", "OO"};
+const std::vector<std::string> beehive = {".OO.", "O..O", ".OO."};
+const std::vector<std::string> boat = {"OO.", "O.O", ".O."};
+const std::vector<std::string> pulsar = {
+    "..OOO...OOO..", ".............", "O....O.O....O", "O....O.O....O",
+    "O....O.O....O", "..OOO...OOO..", ".............", "..OOO...OOO..",
+    "O....O.O....O", "O....O.O....O", "O....O.O....O", ".............",
+    "..OOO...OOO.."};
+
+/*!@brief Turn a pattern: transpose it first if asked, then mirror it.
+ *@param Rows of the pattern, '.' dead and 'O' alive.
+ *@param Whether to mirror the columns.
+ *@param Whether to mirror the rows.
+ *@param Whether to transpose.
+ */
+std::vector<std::string> turn(const std::vector<std::string> &rows,
+                              bool flip_x, bool flip_y, bool transpose) {
+    std::vector<std::string> out = rows;
+
+    if (transpose) {
+        out.assign(rows[0].size(), std::string(rows.size(), '.'));
+        for (std::size_t y = 0; y < rows.size(); y++) {
+            for (std::size_t x = 0; x < rows[y].size(); x++) {
+                out[x][y] = rows[y][x];
+            }
+        }
+    }
+    if (flip_x) {
+        for (std::string &row : out) {
+            row.assign(row.rbegin(), row.rend());
+        }
+    }
+    if (flip_y) {
+        out = std::vector<std::string>(out.rbegin(), out.rend());
+    }
+
+    return out;
+}
+
+//! Put a pattern on a board, its corner at (top, left).
+void place(Board &board, const std::vector<std::string> &rows, int top,
+           int left) {
+    for (std::size_t y = 0; y < rows.size(); y++) {
+        for (std::size_t x = 0; x < rows[y].size(); x++) {
+            if (rows[y][x] == 'O') {
+                board.set(top + (int)y, left + (int)x, 1);
+            }
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    Board board(board_rows, board_cols);
+
+    // Gliders of 6 orientations.
+    place(board, glider, 2, 2);                               // (1, 1)
+    place(board, turn(glider, true, false, false), 2, 20);    // (-1, 1)
+    place(board, turn(glider, false, true, false), 2, 38);    // (1, -1)
+    place(board, turn(glider, true, true, false), 2, 56);     // (-1, -1)
+    place(board, turn(glider, false, false, true), 2, 74);    // (1, 1)
+    place(board, turn(glider, true, false, true), 2, 92);     // (-1, 1)
+
+    // LWSS heading the 4 ways, three of them across seams.
+    place(board, lwss, 19, 2);                                // (2, 0)
+    place(board, turn(lwss, true, false, false), 12, 30);     // (-2, 0)
+    place(board, turn(lwss, false, false, true), 38, 60);     // (0, 2)
+    place(board, turn(lwss, false, true, true), 58, 60);      // (0, -2)
+
+    // Still lifes and oscillators, some across seams.
+    place(board, blinker, 45, 2);
+    place(board, turn(blinker, false, false, true), 40, 20);
+    place(board, block, 60, 2);
+    place(board, beehive, 45, 100);
+    place(board, turn(beehive, false, false, true), 59, 100);
+    place(board, boat, 70, 2);
+    place(board, turn(boat, true, false, false), 70, 12);
+    place(board, turn(boat, false, true, false), 70, 22);
+    place(board, turn(boat, true, true, false), 70, 32);
+    place(board, pulsar, 20, 120);
+
+    std::vector<Expected> expected = {
+        {"glider", 1, 1, 2},  {"glider", -1, 1, 2}, {"glider", 1, -1, 1},
+        {"glider", -1, -1, 1}, {"LWSS", 2, 0, 1},   {"LWSS", -2, 0, 1},
+        {"LWSS", 0, 2, 1},    {"LWSS", 0, -2, 1},   {"blinker", 0, 0, 2},
+        {"block", 0, 0, 1},   {"beehive", 0, 0, 2}, {"boat", 0, 0, 4},
+        {"pulsar", 0, 0, 1}};
+    std::sort(expected.begin(), expected.end());
+
+    Rule rule;
+    parse_rule("B3/S23", rule);
+    Census census(find_kernel("auto", false), rule);
+
+    int checks = 0, failures = 0;
+    for (int threads = 1; threads <= 6; threads++) {
+        std::unique_ptr<ThreadPool> pool;
+        if (threads > 1) {
+            pool.reset(new ThreadPool(threads));
+        }
+
+        // Twice: the second census finds every object in the table.
+        for (int pass = 0; pass < 2; pass++) {
+            census.take(board.cells(), pool.get());
+
+            std::vector<Expected> found;
+            for (const CensusEntry &entry : census.objects()) {
+                found.push_back({entry.name, entry.dx, entry.dy, entry.count});
+            }
+            std::sort(found.begin(), found.end());
+
+            checks++;
+            if ((found != expected) || (census.total() != 20)) {
+                failures++;
+                std::cerr << "FAIL " << threads << " thread(s), pass "
+                          << pass << ": " << census.total() << " objects\n";
+                for (const Expected &entry : found) {
+                    std::cerr << "    " << entry.count << " " << entry.name
+                              << " (" << entry.dx << ", " << entry.dy
+                              << ")\n";
+                }
+            }
+        }
+    }
+
+    std::cout << "census_test: " << checks - failures << "/" << checks
+              << " censuses of 20 known objects passed\n";
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,73 @@
+/*!
+ * \file count_allocations.h
+ * \brief Counts the heap allocations of a program (make test, make bench).
+ *
+ * Replaces the global operator new and delete, sized and array forms
+ * included, and posix_memalign(), which Grid allocates its rows with. To be
+ * included by a single source file of the program.
+ */
+
+#ifndef COUNT_ALLOCATIONS_H
+#define COUNT_ALLOCATIONS_H
+
+// C
+#include <malloc.h>  // memalign()
+#include <stdlib.h>  // posix_memalign()
+
+#include <cerrno>   // EINVAL, ENOMEM
+#include <cstddef>  // std::size_t
+#include <cstdlib>  // std::malloc(), std::free()
+
+// C++
+#include <atomic>  // std::atomic
+#include <new>     // std::bad_alloc
+
+namespace {
+
+//! Heap allocations made by this process.
+std::atomic<long long> allocations(0);
+
+}  // namespace
+
+//! Count the allocations of the process (operator new[] comes here too).
+void *operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    void *block = std::malloc(size ? size : 1);
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+
+void operator delete(void *block) noexcept { std::free(block); }
+
+void operator delete[](void *block) noexcept { std::free(block); }
+
+void operator delete(void *block, std::size_t) noexcept { std::free(block); }
+
+void operator delete[](void *block, std::size_t) noexcept {
+    std::free(block);
+}
+
+//! Count the aligned allocations too: the rows of a Grid come from here.
+extern "C" int posix_memalign(void **block, std::size_t alignment,
+                              std::size_t size) noexcept {
+    if ((alignment % sizeof(void *) != 0) ||
+        ((alignment & (alignment - 1)) != 0)) {
+        return EINVAL;
+    }
+
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    void *aligned = memalign(alignment, size ? size : 1);
+    if (aligned == nullptr) {
+        return ENOMEM;
+    }
+    *block = aligned;
+    return 0;
+}
+
+#endif
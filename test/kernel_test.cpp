@@ -0,0 +1,159 @@
+/*!
+ * \file kernel_test.cpp
+ * \brief Checks every step kernel against the reference code (make test).
+ *
+ * Each kernel find_kernel() can dispatch on this CPU, the scalar one
+ * included, B3/S23 and any-rule, steps the given patterns and a few random
+ * soups (wide enough for the SIMD kernels to take several words at once)
+ * under dead, torus and mirror boundaries. After every generation its
+ * cells must be those of the reference code, surroundings() and the table
+ * of the rule.
+ */
+
+// C
+#include <cstdlib>  // EXIT_SUCCESS, EXIT_FAILURE
+
+// C++
+#include <iostream>  // std::cout, std::cerr
+#include <random>    // std::mt19937_64
+#include <string>    // std::string
+#include <vector>    // std::vector
+
+#include "../include/board.h"
+#include "../include/kernel.h"
+#include "../include/rule.h"
+#include "../include/tile_step.h"
+
+namespace {
+
+//! Generations stepped by each check.
+const int generations = 64;
+
+//! Board to step.
+struct Pattern {
+    std::string name;  //!< Name in the report.
+    Board board;       //!< Cells of generation 0.
+};
+
+//! Step a grid one generation with the reference code.
+void reference_step(Grid &front, Grid &back, const Rule &rule,
+                    Boundary boundary) {
+    front.fill_halo(boundary);
+    for (int i = 1; i <= front.rows(); i++) {
+        for (int j = 1; j <= front.cols(); j++) {
+            const int n = surroundings(front, i, j);  // Number of neighbors
+            back.set(i, j, rule.next[front.get(i, j)][n]);
+        }
+    }
+    front.swap(back);
+}
+
+//! Step a grid one generation with a kernel.
+void kernel_step(Grid &front, Grid &back, const Rule &rule,
+                 Boundary boundary, step_kernel kernel) {
+    front.fill_halo(boundary);
+    StepSpan span = full_span(front, back);
+    span.birth = rule.birth;
+    span.survive = rule.survive;
+    kernel(span);
+    front.swap(back);
+}
+
+/*!@brief Step a pattern with a kernel and with the reference code.
+ *@return The first generation where they differ, 0 if none does.
+ */
+int compare(const Board &board, const Rule &rule, Boundary boundary,
+            step_kernel kernel) {
+    Grid expected = board.cells(), expected_back = board.cells();
+    Grid actual = board.cells(), actual_back = board.cells();
+
+    for (int gen = 1; gen <= generations; gen++) {
+        reference_step(expected, expected_back, rule, boundary);
+        kernel_step(actual, actual_back, rule, boundary, kernel);
+        if (!actual.same_cells(expected)) {
+            return gen;
+        }
+    }
+
+    return 0;
+}
+
+//! Random soup of the given size.
+Pattern soup(int rows, int cols, std::mt19937_64 &random) {
+    Pattern pattern;
+    pattern.name = "soup " + std::to_string(rows) + "x" + std::to_string(cols);
+    pattern.board = Board(rows, cols);
+
+    std::bernoulli_distribution alive(0.35);
+    for (int i = 1; i <= rows; i++) {
+        for (int j = 1; j <= cols; j++) {
+            pattern.board.set(i, j, alive(random));
+        }
+    }
+
+    return pattern;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    std::vector<Pattern> patterns;
+    for (int a = 1; a < argc; a++) {
+        Pattern pattern;
+        pattern.name = argv[a];
+        if (!pattern.board.load(argv[a])) {
+            std::cerr << "Could not read [" << argv[a] << "]\n";
+            return EXIT_FAILURE;
+        }
+        patterns.push_back(pattern);
+    }
+
+    // Ragged last words, one word, and more words than a 512-bit register.
+    std::mt19937_64 random(20240601);
+    patterns.push_back(soup(37, 61, random));
+    patterns.push_back(soup(70, 64, random));
+    patterns.push_back(soup(131, 700, random));
+
+    const char *kernels[] = {"scalar", "sse2", "avx2", "avx512"};
+    const char *rules[] = {"B3/S23", "B36/S23", "B2/S"};
+    const Boundary boundaries[] = {Boundary::dead, Boundary::torus,
+                                   Boundary::mirror};
+    const char *boundary_names[] = {"dead", "torus", "mirror"};
+
+    int checks = 0, failures = 0;
+    for (const char *name : kernels) {
+        for (const char *rule_name : rules) {
+            Rule rule;
+            parse_rule(rule_name, rule);
+
+            // B3/S23 has kernels of its own; check the any-rule ones too.
+            for (int any_rule = rule.is_life() ? 0 : 1; any_rule < 2;
+                 any_rule++) {
+                step_kernel kernel = find_kernel(name, any_rule != 0);
+                if (kernel == nullptr) {
+                    continue;  // Not supported by this CPU.
+                }
+
+                for (const Pattern &pattern : patterns) {
+                    for (int b = 0; b < 3; b++) {
+                        const int gen =
+                            compare(pattern.board, rule, boundaries[b], kernel);
+                        checks++;
+                        if (gen != 0) {
+                            failures++;
+                            std::cerr << "FAIL " << name
+                                      << (any_rule ? " any-rule " : " ")
+                                      << rule_name << " " << boundary_names[b]
+                                      << " " << pattern.name
+                                      << ": generation " << gen << "\n";
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    std::cout << "kernel_test: " << checks - failures << "/" << checks
+              << " checks passed (" << auto_kernel_name() << " CPU)\n";
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}